@@ -10,9 +10,34 @@ public:
     // How fast the camera follows the target (0 < lerpFactor ≤ 1)
     float lerpFactor = 0.1f;  // smaller = smoother, slower
 
+    // Screen pixels per world pixel. view.w/h are in world units, so they
+    // shrink as this grows; the world pass applies it as the render scale.
+    float zoom = 1.0f;
+    static constexpr float kMinZoom = 1.0f / 64.0f;
+    static constexpr float kMaxZoom = 4.0f;
+
     void setViewport(float width, float height) {
-        view.w = width;
-        view.h = height;
+        screenW = width;
+        screenH = height;
+        view.w = width / zoom;
+        view.h = height / zoom;
+    }
+
+    // keeps the centre of the view where it was
+    void setZoom(float z) {
+        z = std::clamp(z, kMinZoom, kMaxZoom);
+        const float cx = view.x + view.w * 0.5f, cy = view.y + view.h * 0.5f;
+        zoom = z;
+        view.w = screenW / zoom;
+        view.h = screenH / zoom;
+        view.x = cx - view.w * 0.5f;
+        view.y = cy - view.h * 0.5f;
+    }
+
+    // zoom that shows the whole world in the viewport
+    float fitZoom(float worldW, float worldH) const {
+        if (worldW <= 0.f || worldH <= 0.f) return 1.0f;
+        return std::clamp(std::min(screenW / worldW, screenH / worldH), kMinZoom, kMaxZoom);
     }
 
     void follow(float targetX, float targetY, float worldW, float worldH) {
@@ -24,8 +49,11 @@ public:
         view.x += (desiredX - view.x) * lerpFactor;
         view.y += (desiredY - view.y) * lerpFactor;
 
-        // Clamp camera to world boundaries
-        view.x = std::max(0.0f, std::min(view.x, worldW - view.w));
-        view.y = std::max(0.0f, std::min(view.y, worldH - view.h));
+        // Clamp camera to world boundaries; centre the world if it is smaller than the view
+        view.x = worldW < view.w ? (worldW - view.w) * 0.5f : std::max(0.0f, std::min(view.x, worldW - view.w));
+        view.y = worldH < view.h ? (worldH - view.h) * 0.5f : std::max(0.0f, std::min(view.y, worldH - view.h));
     }
+
+private:
+    float screenW = 0.f, screenH = 0.f;
 };
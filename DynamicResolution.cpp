@@ -0,0 +1,103 @@
+#include "DynamicResolution.h"
+#include "Log.h"
+#include "MemoryStats.h"
+#include <algorithm>
+#include <cmath>
+
+bool DynamicResolution::init(SDL_Renderer* r, int outW, int outH, float targetFps) {
+    ren_ = r;
+    targetFps_ = targetFps > 0.f ? targetFps : 60.f;
+    resize(outW, outH);
+    return target_ != nullptr;
+}
+
+void DynamicResolution::resize(int outW, int outH) {
+    outW = std::max(outW, 1);
+    outH = std::max(outH, 1);
+    int texW = 0, texH = 0;
+    if (!SDL_GetRenderOutputSize(ren_, &texW, &texH) || texW <= 0 || texH <= 0) {
+        texW = outW;
+        texH = outH;
+    }
+    if (target_ && outW == outW_ && outH == outH_ && texW == texW_ && texH == texH_) return;
+    outW_ = outW;
+    outH_ = outH;
+    texW_ = texW;
+    texH_ = texH;
+    holdOff_ = 1.f;   // new size, new costs: re-learn from scratch
+
+    shutdown();
+    target_ = SDL_CreateTexture(ren_, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_TARGET, texW_, texH_);
+    if (!target_) {
+        BR_LOG_WARN("No render target for dynamic resolution ({}), drawing at native size", std::string_view(SDL_GetError()));
+        return;
+    }
+    brmem::trackTexture(MemTag::Render, target_);
+    SDL_SetTextureScaleMode(target_, SDL_SCALEMODE_LINEAR);
+}
+
+void DynamicResolution::shutdown() {
+    brmem::untrackTexture(MemTag::Render, target_);
+    if (target_) SDL_DestroyTexture(target_);
+    target_ = nullptr;
+}
+
+void DynamicResolution::beginWorld(SDL_Color clear, float zoom) {
+    float s = zoom;
+    if (enabled()) {
+        SDL_SetRenderTarget(ren_, target_);
+        s *= scale_ * float(texW_) / float(outW_);   // the target counts pixels, not window units
+    }
+    SDL_SetRenderScale(ren_, s, s);
+    SDL_SetRenderDrawColor(ren_, clear.r, clear.g, clear.b, clear.a);
+    SDL_RenderClear(ren_);
+}
+
+void DynamicResolution::endWorld() {
+    SDL_SetRenderScale(ren_, 1.f, 1.f);
+    if (!enabled()) return;
+    SDL_SetRenderTarget(ren_, nullptr);
+
+    const SDL_FRect src{ 0.f, 0.f, float(texW_) * scale_, float(texH_) * scale_ };
+    const SDL_FRect dst{ 0.f, 0.f, float(outW_), float(outH_) };
+    SDL_RenderTexture(ren_, target_, &src, &dst);
+}
+
+void DynamicResolution::frameTime(double seconds) {
+    if (!enabled() || seconds <= 0.0 || seconds > 0.25) return;   // hitches (dialogs, drags) say nothing about load
+    avg_ = avg_ == 0.0 ? seconds : avg_ + (seconds - avg_) * 0.1;
+    sinceUp_ += float(seconds);
+
+    if (cooldown_ > 0.f) { cooldown_ -= float(seconds); return; }
+
+    const double budget = 1.0 / targetFps_;
+    const float prev = scale_;
+    if (avg_ > budget * 1.10) {
+        if (sinceUp_ < 2.f) {
+            // the last step up did not hold: undo it and wait longer before trying again
+            scale_ = std::max(kMinScale, scale_ - kStep);
+            holdOff_ = std::min(holdOff_ * 2.f, 8.f);
+        } else {
+            // fill cost goes with pixel count, i.e. scale squared
+            const float want = scale_ * float(std::sqrt(budget / avg_));
+            scale_ = std::max(kMinScale, std::min(scale_ - kStep, std::floor(want / kStep) * kStep));
+        }
+        goodTime_ = 0.f;
+    } else if (avg_ < budget * 1.03) {
+        goodTime_ += float(seconds);
+        if (goodTime_ >= holdOff_ && scale_ < kMaxScale) {
+            if (sinceUp_ >= 2.f) holdOff_ = std::max(1.f, holdOff_ * 0.5f);   // the previous step held
+            scale_ = std::min(kMaxScale, scale_ + kStep);
+            goodTime_ = 0.f;
+            sinceUp_ = 0.f;
+        }
+    } else {
+        goodTime_ = 0.f;
+    }
+
+    if (scale_ != prev) {
+        BR_LOG_DEBUG("Render scale {} -> {} at {} ms/frame", prev, scale_, avg_ * 1000.0);
+        cooldown_ = 0.25f;
+        avg_ = 0.0;   // let the new scale show its own cost
+    }
+}
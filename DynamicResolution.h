@@ -0,0 +1,54 @@
+#pragma once
+#include <SDL3/SDL.h>
+
+// Renders the world pass into an offscreen target at a variable fraction of
+// the output size and stretches it back up at present. The scale follows
+// measured frame time: it drops quickly when frames run over budget and
+// creeps back up after a stretch of frames that fit.
+//
+// The target texture is allocated once at the full output size in pixels
+// (which on HiDPI displays is larger than the window size the game draws
+// in); lower scales only use its top-left corner, so scale changes never
+// reallocate.
+class DynamicResolution {
+public:
+    static constexpr float kMinScale = 0.5f;
+    static constexpr float kMaxScale = 1.0f;
+    static constexpr float kStep     = 0.05f;
+
+    // false if the renderer cannot render to textures (world draws direct)
+    // outW/outH: the size the world is drawn at (window coordinates)
+    bool init(SDL_Renderer* r, int outW, int outH, float targetFps);
+    void resize(int outW, int outH);   // also after pixel density changes
+    void shutdown();
+
+    // world pass: everything drawn between these lands in the target at
+    // scale(); zoom (camera world-to-screen) is folded into the render scale
+    void beginWorld(SDL_Color clear, float zoom = 1.f);
+    void endWorld();
+
+    // feed once per frame with the present-to-present interval
+    void frameTime(double seconds);
+
+    float scale() const { return enabled() ? scale_ : 1.f; }
+    bool  enabled() const { return enabled_ && target_ != nullptr; }   // requested and have a target
+    bool  isRequested() const { return enabled_; }
+    void  setEnabled(bool on) { enabled_ = on; }
+    float targetFps() const { return targetFps_; }
+
+private:
+    SDL_Renderer* ren_{nullptr};
+    SDL_Texture*  target_{nullptr};
+    int   outW_{0}, outH_{0};       // window coordinates
+    int   texW_{0}, texH_{0};       // output pixels
+    float scale_{kMaxScale};
+    bool  enabled_{true};
+
+    // controller
+    float  targetFps_{60.f};
+    double avg_{0.0};          // smoothed frame time, seconds
+    float  goodTime_{0.f};     // seconds in a row under budget
+    float  holdOff_{1.f};      // seconds of good frames needed before stepping up
+    float  sinceUp_{1e9f};     // seconds since the last step up
+    float  cooldown_{0.f};     // no further changes while the last one settles
+};
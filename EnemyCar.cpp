@@ -1,34 +1,38 @@
 #include "EnemyCar.h"
 #include "Camera.h"
+#include "Log.h"
+#include "RenderQueue.h"
+#include "WorldState.h"
+#include "NavGraph.h"
+#include "Pvs.h"
 #include <algorithm>
-#include <cstdlib>
 
 static inline float deg2rad(float d){ return d * 3.14159265358979323846f / 180.f; }
 static inline float rad2deg(float r){ return r * 180.f / 3.14159265358979323846f; }
 static inline float clampf(float v,float lo,float hi){ return std::max(lo,std::min(hi,v)); }
 
+static const char* modeName(EnemyCar::Mode m) {
+    switch (m) {
+        case EnemyCar::Mode::Patrol:  return "Patrol";
+        case EnemyCar::Mode::Chase:   return "Chase";
+        case EnemyCar::Mode::Blinded: return "Blinded";
+    }
+    return "?";
+}
+
 EnemyCar::EnemyCar(float x, float y) : x_(x), y_(y) {}
 
 bool EnemyCar::wallAhead(const Map& map, float probeDist) const {
+    // one distance-field lookup covers the whole car width at the probe point
     const float ang = deg2rad(headingDeg_);
     const float nx = x_ + std::cos(ang) * probeDist;
     const float ny = y_ + std::sin(ang) * probeDist;
-    return map.isWallAtPixel(nx, ny);
+    return map.clearanceAt(nx, ny) < height_ * 0.5f;
 }
 
-bool EnemyCar::canSee(const Map& map, float tx, float ty) const {
-    const float dx = tx - x_;
-    const float dy = ty - y_;
-    const float dist = std::max(1.f, std::sqrt(dx*dx + dy*dy));
-    const int   steps = int(dist / 6.f);
-    const float stepx = dx / steps;
-    const float stepy = dy / steps;
-    float px = x_, py = y_;
-    for (int i=0;i<steps;i++){
-        px += stepx; py += stepy;
-        if (map.isWallAtPixel(px, py)) return false;
-    }
-    return true;
+bool EnemyCar::canSee(const Map& map, const Pvs& pvs, float tx, float ty) const {
+    if (!pvs.mayBeVisible(x_, y_, tx, ty)) return false;   // regions that never see each other: no ray
+    return map.lineOfSight(x_, y_, tx, ty);
 }
 
 void EnemyCar::turnToward(float tx, float ty, float dt){
@@ -41,6 +45,26 @@ void EnemyCar::turnToward(float tx, float ty, float dt){
     headingDeg_ += delta;
 }
 
+void EnemyCar::steerToward(const Map& map, float tx, float ty, float dt){
+    static constexpr float kAvoidDist = 24.f;   // start easing off walls inside this clearance
+
+    float dx = tx - x_, dy = ty - y_;
+    const float len = std::sqrt(dx*dx + dy*dy);
+    if (len < 1e-3f) return;
+    dx /= len; dy /= len;
+
+    // blend in the field gradient (points away from the nearest walls) so
+    // cars round corners and slide along walls instead of grinding into them
+    const float clear = map.clearanceAt(x_, y_);
+    if (clear < kAvoidDist) {
+        const SDL_FPoint g = map.clearanceGradientAt(x_, y_);
+        const float w = (kAvoidDist - clear) / kAvoidDist;
+        dx += g.x * w;
+        dy += g.y * w;
+    }
+    turnToward(x_ + dx * 64.f, y_ + dy * 64.f, dt);
+}
+
 void EnemyCar::turnAwayFrom(float tx, float ty, float dt){
     const float angFrom = rad2deg(std::atan2(y_ - ty, x_ - tx));
     float delta = angFrom - headingDeg_;
@@ -51,29 +75,61 @@ void EnemyCar::turnAwayFrom(float tx, float ty, float dt){
     headingDeg_ += delta;
 }
 
-void EnemyCar::update(float dt, const Map& map, float playerX, float playerY){
-    const bool seePlayer = canSee(map, playerX, playerY);
+void EnemyCar::planRoute(const NavGraph& nav, Rng& rng) {
+    // keep heading for the current goal if the last route was cut short
+    if (hasGoal_) {
+        const float dx = goalX_ - x_, dy = goalY_ - y_;
+        if (dx*dx + dy*dy < 24.f * 24.f) hasGoal_ = false;
+    }
+    if (!hasGoal_) hasGoal_ = nav.randomPatrolTarget(rng, x_, y_, goalX_, goalY_);
+
+    routeLen_ = hasGoal_ ? nav.findRoute(x_, y_, goalX_, goalY_, route_.data(), kMaxWaypoints) : 0;
+    routeIdx_ = 0;
+    waypointTimer_ = 0.f;
+    if (routeLen_ == 0) hasGoal_ = false;
+}
+
+void EnemyCar::followRoute(float dt, const Map& map, const NavGraph& nav, Rng& rng) {
+    static constexpr float kArrive = 12.f;
+    static constexpr float kWaypointTimeout = 5.f; // boxed in by something: re-plan
+
+    waypointTimer_ += dt;
+    if (routeIdx_ < routeLen_) {
+        const float dx = route_[routeIdx_].x - x_, dy = route_[routeIdx_].y - y_;
+        if (dx*dx + dy*dy < kArrive * kArrive) { ++routeIdx_; waypointTimer_ = 0.f; }
+    }
+    if (routeIdx_ >= routeLen_ || waypointTimer_ > kWaypointTimeout) planRoute(nav, rng);
+
+    if (routeIdx_ >= routeLen_) {
+        // nowhere reachable to go: idle drift
+        headingDeg_ += (rng.range(3) - 1) * 20.f * dt;
+        speed_ = patrolSpeed_ * 0.5f;
+        return;
+    }
+
+    const SDL_FPoint wp = route_[routeIdx_];
+    steerToward(map, wp.x, wp.y, dt);
+
+    // slow down while still facing away so the turn circle fits inside the arrival radius
+    float off = rad2deg(std::atan2(wp.y - y_, wp.x - x_)) - headingDeg_;
+    while (off > 180.f) off -= 360.f;
+    while (off < -180.f) off += 360.f;
+    speed_ = patrolSpeed_ * clampf(std::cos(deg2rad(off)), 0.3f, 1.f);
+}
+
+void EnemyCar::update(float dt, const Map& map, const NavGraph& nav, const Pvs& pvs, Rng& rng, float playerX, float playerY){
+    const bool seePlayer = canSee(map, pvs, playerX, playerY);
+    const Mode prevMode = mode_;
 
     switch (mode_){
         case Mode::Patrol:
             if (seePlayer) mode_ = Mode::Chase;
-            if (wallAhead(map, 18.f)) {
-                float leftAng  = deg2rad(headingDeg_ + 60.f);
-                float rightAng = deg2rad(headingDeg_ - 60.f);
-                bool leftFree  = !map.isWallAtPixel(x_ + std::cos(leftAng)*18.f,  y_ + std::sin(leftAng)*18.f);
-                bool rightFree = !map.isWallAtPixel(x_ + std::cos(rightAng)*18.f, y_ + std::sin(rightAng)*18.f);
-                if (leftFree && !rightFree)      headingDeg_ += 60.f;
-                else if (rightFree && !leftFree) headingDeg_ -= 60.f;
-                else headingDeg_ += (std::rand()%2 ? 50.f : -50.f);
-            } else {
-                headingDeg_ += (std::rand()%3 - 1) * 20.f * dt;
-            }
-            speed_ = patrolSpeed_;
+            followRoute(dt, map, nav, rng);
             break;
 
         case Mode::Chase:
             if (!seePlayer) mode_ = Mode::Patrol;
-            turnToward(playerX, playerY, dt);
+            steerToward(map, playerX, playerY, dt);
             speed_ = wallAhead(map, 28.f) ? patrolSpeed_ : chaseSpeed_;
             break;
 
@@ -94,26 +150,26 @@ void EnemyCar::update(float dt, const Map& map, float playerX, float playerY){
 
     if (headingDeg_ > 180.f) headingDeg_ -= 360.f;
     if (headingDeg_ < -180.f) headingDeg_ += 360.f;
+
+    // came back to patrol from elsewhere: the cached route starts somewhere else now
+    if (mode_ == Mode::Patrol && prevMode != Mode::Patrol) routeLen_ = routeIdx_ = 0;
+
+    if (mode_ != prevMode)
+        BR_LOG_DEBUG("Enemy at ({}, {}) {} -> {}", x_, y_, modeName(prevMode), modeName(mode_));
 }
 
-void EnemyCar::render(SDL_Renderer* r, SDL_Texture* tex, const Camera& cam) const {
+void EnemyCar::render(RenderQueue& q, SDL_Texture* tex, const Camera& cam) const {
     const float scale = 1.0f;
     SDL_FRect dst {
         (x_ - cam.view.x) - (width_ * scale) * 0.5f,
         (y_ - cam.view.y) - (height_ * scale) * 0.5f,
         width_ * scale, height_ * scale
     };
-    SDL_FPoint center{ dst.w * 0.5f, dst.h * 0.5f };
 
     // Base sprite faces UP (north). Our heading uses 0°=+X, 90°=+Y (down).
     // To rotate an UP-facing sprite to match heading, add +90°.
     // If it looks mirrored, use -(headingDeg_ + 90.f) instead.
-    const double renderAngle = double(headingDeg_ + 90.f);
+    const float renderAngle = headingDeg_ + 90.f;
 
-    if (tex) {
-        SDL_RenderTextureRotated(r, tex, nullptr, &dst, renderAngle, &center, SDL_FLIP_NONE);
-    } else {
-        SDL_SetRenderDrawColor(r, 220, 50, 50, 255);
-        SDL_RenderFillRect(r, &dst);
-    }
+    q.sprite(RenderLayer::Enemies, tex, dst, renderAngle, tex ? SDL_Color{255, 255, 255, 255} : SDL_Color{220, 50, 50, 255});
 }
@@ -1,17 +1,22 @@
 #pragma once
 #include <SDL3/SDL.h>
+#include <array>
 #include <cmath>
 #include "Map.h"
 class Camera; // forward declaration
+class RenderQueue;
+class NavGraph;
+class Pvs;
+struct Rng;
 
 class EnemyCar {
 public:
     enum class Mode { Patrol, Chase, Blinded };
 
-    EnemyCar(float x, float y);
+    EnemyCar(float x = 0.f, float y = 0.f);
 
-    void update(float dt, const Map& map, float playerX, float playerY);
-    void render(SDL_Renderer* r, SDL_Texture* tex, const Camera& cam) const;
+    void update(float dt, const Map& map, const NavGraph& nav, const Pvs& pvs, Rng& rng, float playerX, float playerY);
+    void render(RenderQueue& q, SDL_Texture* tex, const Camera& cam) const;
 
     // temporarily blinds the enemy (e.g. smoke)
     void blind(float seconds) { mode_ = Mode::Blinded; blindTimer_ = seconds; }
@@ -25,9 +30,12 @@ public:
 private:
     // helpers
     void turnToward(float targetX, float targetY, float dt);
+    void steerToward(const Map& map, float targetX, float targetY, float dt); // turnToward + wall avoidance
     void turnAwayFrom(float targetX, float targetY, float dt);
     bool wallAhead(const Map& map, float probeDist) const;
-    bool canSee(const Map& map, float tx, float ty) const;
+    bool canSee(const Map& map, const Pvs& pvs, float tx, float ty) const;
+    void planRoute(const NavGraph& nav, Rng& rng);
+    void followRoute(float dt, const Map& map, const NavGraph& nav, Rng& rng);
 
     // state
     float x_{}, y_{};
@@ -36,6 +44,14 @@ private:
     Mode  mode_{Mode::Patrol};
     float blindTimer_{0.f};
 
+    // patrol route (cached waypoints from the nav graph, re-planned at its end)
+    static constexpr int kMaxWaypoints = 12;
+    std::array<SDL_FPoint, kMaxWaypoints> route_{};
+    int   routeLen_{0}, routeIdx_{0};
+    bool  hasGoal_{false};
+    float goalX_{}, goalY_{};
+    float waypointTimer_{0.f};
+
     // tuning
     float chaseSpeed_{130.f};
     float patrolSpeed_{90.f};
@@ -0,0 +1,172 @@
+#include "FrameCapture.h"
+#include "Log.h"
+#include "MemoryStats.h"
+#include <SDL3_image/SDL_image.h>
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+
+bool FrameCapture::start(SDL_Renderer* r, const std::string& dir, Format format, float fps) {
+    stop();
+    folder_.clear();
+    w_ = h_ = 0;
+    SDL_GetRenderOutputSize(r, &w_, &h_);
+    if (w_ <= 0 || h_ <= 0 || fps <= 0.f) return false;
+
+    // next free numbered folder: dir/001, dir/002, ...
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    fs::create_directories(dir, ec);
+    for (int n = 1; n < 1000; ++n) {
+        char name[8];
+        std::snprintf(name, sizeof name, "%03d", n);
+        const fs::path p = fs::path(dir) / name;
+        if (fs::exists(p, ec)) continue;
+        if (fs::create_directory(p, ec)) folder_ = p.generic_string();
+        break;
+    }
+    if (folder_.empty()) {
+        BR_LOG_ERROR("Cannot create a capture folder in {}", dir);
+        return false;
+    }
+
+    format_ = format;
+    index_ = std::fopen((folder_ + "/index.txt").c_str(), "w");
+    if (format_ == Format::Raw) {
+        raw_ = std::fopen((folder_ + "/capture.rgba").c_str(), "wb");
+        if (FILE* info = std::fopen((folder_ + "/capture.txt").c_str(), "w")) {
+            // e.g. ffmpeg -f rawvideo -pixel_format rgba -video_size WxH -framerate FPS -i capture.rgba
+            std::fprintf(info, "width %d\nheight %d\nfps %g\npixels rgba\n", w_, h_, double(fps));
+            std::fclose(info);
+        }
+    }
+    if (!index_ || (format_ == Format::Raw && !raw_)) {
+        BR_LOG_ERROR("Cannot open capture files in {}", folder_);
+        if (index_) std::fclose(index_);
+        if (raw_) std::fclose(raw_);
+        index_ = raw_ = nullptr;
+        folder_.clear();
+        return false;
+    }
+    std::fprintf(index_, "# frame time_ms (missing frames were dropped)\n");
+
+    for (Slot& s : slots_) s.pixels.reset(new uint8_t[size_t(w_) * h_ * 4]);
+    intervalNs_ = uint64_t(1e9 / double(fps));
+    startNs_ = nextNs_ = SDL_GetTicksNS();
+    frame_ = 0;
+    head_.store(0, std::memory_order_relaxed);
+    tail_.store(0, std::memory_order_relaxed);
+    captured_ = dropped_ = 0;
+    readSum_ = readMax_ = 0.0;
+    encodeNs_.store(0, std::memory_order_relaxed);
+    stopping_.store(false, std::memory_order_relaxed);
+    thread_ = std::thread(&FrameCapture::encode, this);
+
+    BR_LOG_INFO("Recording {}x{} at {} fps to {}", w_, h_, fps, folder_);
+    return true;
+}
+
+void FrameCapture::stop() {
+    if (!active()) return;
+    stopping_.store(true, std::memory_order_release);
+    wake_.fetch_add(1, std::memory_order_release);
+    wake_.notify_one();
+    thread_.join();
+
+    if (raw_) std::fclose(raw_);
+    if (index_) std::fclose(index_);
+    raw_ = index_ = nullptr;
+
+    const uint64_t written = tail_.load(std::memory_order_relaxed);
+    BR_LOG_INFO("Recording stopped: {} frames written, {} dropped, in {}", written, dropped_, folder_);
+    if (captured_ > 0)
+        BR_LOG_INFO("Capture cost: {} ms avg, {} ms max on the render thread; {} ms per frame to encode",
+                    readSum_ / double(captured_), readMax_,
+                    written ? double(encodeNs_.load(std::memory_order_relaxed)) / double(written) * 1e-6 : 0.0);
+    folder_.clear();
+}
+
+void FrameCapture::capture(SDL_Renderer* r) {
+    if (!active()) return;
+    const uint64_t now = SDL_GetTicksNS();
+    if (now < nextNs_) return;
+    nextNs_ = (now - nextNs_ > intervalNs_ ? now : nextNs_) + intervalNs_;   // after a hitch, don't burst
+    const uint64_t frame = frame_++;
+
+    // every slot still queued: the encoder is behind, skip this one
+    const uint64_t head = head_.load(std::memory_order_relaxed);
+    if (head - tail_.load(std::memory_order_acquire) >= kSlots) {
+        ++dropped_;
+        return;
+    }
+
+    const Uint64 t0 = SDL_GetPerformanceCounter();
+    SDL_Surface* surf = SDL_RenderReadPixels(r, nullptr);
+    if (!surf) {
+        ++dropped_;
+        return;
+    }
+    if (surf->w != w_ || surf->h != h_) {
+        SDL_DestroySurface(surf);
+        BR_LOG_WARN("Output size changed, recording stopped");
+        stop();
+        return;
+    }
+    Slot& s = slots_[head % kSlots];
+    s.readback = surf;   // converted and freed by the encoder
+    s.frame = frame;
+    s.timeNs = now - startNs_;
+
+    head_.store(head + 1, std::memory_order_release);
+    wake_.fetch_add(1, std::memory_order_release);
+    wake_.notify_one();
+
+    const double ms = double(SDL_GetPerformanceCounter() - t0) * 1000.0 / double(SDL_GetPerformanceFrequency());
+    ++captured_;
+    readSum_ += ms;
+    readMax_ = std::max(readMax_, ms);
+}
+
+void FrameCapture::encode() {
+    brmem::Scope scope(MemTag::Render);
+    uint64_t tail = tail_.load(std::memory_order_relaxed);
+    bool failed = false;
+    for (;;) {
+        const uint32_t seen = wake_.load(std::memory_order_acquire);
+        while (tail < head_.load(std::memory_order_acquire)) {
+            const uint64_t t0 = SDL_GetTicksNS();
+            if (!write(slots_[tail % kSlots]) && !failed) {
+                BR_LOG_ERROR("Writing capture frames to {} failed", folder_);
+                failed = true;
+            }
+            encodeNs_.fetch_add(SDL_GetTicksNS() - t0, std::memory_order_relaxed);
+            tail_.store(++tail, std::memory_order_release);
+        }
+        if (stopping_.load(std::memory_order_acquire)) {
+            if (tail == head_.load(std::memory_order_acquire)) break;
+            continue;
+        }
+        wake_.wait(seen, std::memory_order_acquire);
+    }
+}
+
+bool FrameCapture::write(Slot& s) {
+    SDL_ConvertPixels(w_, h_, s.readback->format, s.readback->pixels, s.readback->pitch,
+                      SDL_PIXELFORMAT_RGBA32, s.pixels.get(), w_ * 4);
+    SDL_DestroySurface(s.readback);
+    s.readback = nullptr;
+
+    std::fprintf(index_, "%llu %.3f\n", (unsigned long long)s.frame, double(s.timeNs) * 1e-6);
+    if (format_ == Format::Raw) {
+        const size_t bytes = size_t(w_) * h_ * 4;
+        return std::fwrite(s.pixels.get(), 1, bytes, raw_) == bytes;
+    }
+
+    char name[32];
+    std::snprintf(name, sizeof name, "/frame_%06llu.png", (unsigned long long)s.frame);
+    SDL_Surface* surf = SDL_CreateSurfaceFrom(w_, h_, SDL_PIXELFORMAT_RGBA32, s.pixels.get(), w_ * 4);
+    if (!surf) return false;
+    const bool ok = IMG_SavePNG(surf, (folder_ + name).c_str());
+    SDL_DestroySurface(surf);
+    return ok;
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include <SDL3/SDL.h>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+
+// Gameplay recording. capture() reads the finished backbuffer back and
+// hands the surface to one of kSlots slots; a background thread converts it
+// into the slot's preallocated RGBA buffer, frees it and writes the frame
+// out, either as one raw RGBA stream (capture.rgba, with the size and rate
+// in capture.txt) or as a PNG sequence. When every slot is still waiting
+// for the encoder the frame is dropped, never waited for.
+//
+// SDL_Renderer has no asynchronous readback and no readback into a caller's
+// buffer: each captured frame still syncs with the GPU and allocates one
+// frame-sized surface on the render thread. Both are limited to the capture
+// rate and timed.
+class FrameCapture {
+public:
+    enum class Format { Raw, Png };
+    static constexpr int kSlots = 4;
+
+    FrameCapture() = default;
+    ~FrameCapture() { stop(); }
+    FrameCapture(const FrameCapture&) = delete;
+    FrameCapture& operator=(const FrameCapture&) = delete;
+
+    // Frames go to a new numbered folder under dir.
+    bool start(SDL_Renderer* r, const std::string& dir, Format format, float fps = 30.f);
+    void stop();
+    bool active() const { return thread_.joinable(); }
+
+    // Call after the last draw and before SDL_RenderPresent.
+    void capture(SDL_Renderer* r);
+
+private:
+    struct Slot {
+        SDL_Surface* readback{nullptr};      // as read, until the encoder converts it
+        std::unique_ptr<uint8_t[]> pixels;   // RGBA32, tightly packed
+        uint64_t frame{0};                   // sequence number, gaps are drops
+        uint64_t timeNs{0};                  // since start()
+    };
+
+    void encode();
+    bool write(Slot& s);
+
+    Format       format_{Format::Raw};
+    std::string  folder_;
+    int          w_{0}, h_{0};
+    uint64_t     intervalNs_{0};
+    uint64_t     startNs_{0}, nextNs_{0};
+    uint64_t     frame_{0};
+    FILE*        raw_{nullptr};
+    FILE*        index_{nullptr};
+    Slot         slots_[kSlots];
+
+    // single producer (render thread), single consumer (encoder)
+    alignas(64) std::atomic<uint64_t> head_{0};   // frames handed over
+    alignas(64) std::atomic<uint64_t> tail_{0};   // frames written
+    std::atomic<uint32_t> wake_{0};
+    std::atomic<bool> stopping_{false};
+    std::thread       thread_;
+
+    // render-thread cost of capture() and encoder cost per frame
+    uint64_t captured_{0}, dropped_{0};
+    double   readSum_{0.0}, readMax_{0.0};
+    std::atomic<uint64_t> encodeNs_{0};
+};
@@ -1,5 +1,5 @@
 #include "Game.h"
-#include <iostream>
+#include "Log.h"
 using namespace std;
 
 // Constructor initializes the game state
@@ -16,18 +16,18 @@ void Game::start() {
     running = true;
     score = 0;
     collectedFlags = 0;
-    cout << "Game started! Collect all " << totalFlags << " flags." << endl;
+    BR_LOG_INFO("Game started! Collect all {} flags.", totalFlags);
 }
 
 // Called every "tick" of the game (later SDL will call this per frame)
 void Game::update() {
     if (collectedFlags >= totalFlags) {
-        cout << "All flags collected! You win!" << endl;
+        BR_LOG_INFO("All flags collected! You win!");
         end();
     }
 
     if (lives <= 0) {
-        cout << "Game over!" << endl;
+        BR_LOG_INFO("Game over!");
         end();
     }
 }
@@ -35,7 +35,7 @@ void Game::update() {
 // Ends the game
 void Game::end() {
     running = false;
-    cout << "Final Score: " << score << endl;
+    BR_LOG_INFO("Final Score: {}", score);
 }
 
 // Flag collection
@@ -43,7 +43,7 @@ void Game::collectFlag() {
     if (running && collectedFlags < totalFlags) {
         collectedFlags++;
         score += 100; // arbitrary points per flag
-        cout << "Flag collected! (" << collectedFlags << "/" << totalFlags << ")" << endl;
+        BR_LOG_INFO("Flag collected! ({}/{})", collectedFlags, totalFlags);
     }
 }
 
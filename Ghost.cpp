@@ -0,0 +1,238 @@
+#include "Ghost.h"
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+
+static constexpr char    kMagic[4] = { 'B', 'R', 'G', 'H' };
+static constexpr uint8_t kVersion  = 1;
+
+static void putVarint(std::vector<uint8_t>& out, uint64_t v) {
+    while (v >= 0x80) {
+        out.push_back(uint8_t(v) | 0x80);
+        v >>= 7;
+    }
+    out.push_back(uint8_t(v));
+}
+
+static void putSigned(std::vector<uint8_t>& out, int64_t v) {
+    putVarint(out, (uint64_t(v) << 1) ^ uint64_t(v >> 63));   // zigzag: small magnitudes, small codes
+}
+
+static bool getVarint(const uint8_t* data, size_t end, size_t& pos, uint64_t& v) {
+    v = 0;
+    for (int shift = 0; shift < 64 && pos < end; shift += 7) {
+        const uint8_t b = data[pos++];
+        v |= uint64_t(b & 0x7F) << shift;
+        if (!(b & 0x80)) return true;
+    }
+    return false;
+}
+
+static bool getSigned(const uint8_t* data, size_t end, size_t& pos, int64_t& v) {
+    uint64_t u = 0;
+    if (!getVarint(data, end, pos, u)) return false;
+    v = int64_t(u >> 1) ^ -int64_t(u & 1);
+    return true;
+}
+
+// Where sample `index` of a block should be if the car kept the velocity
+// between the two before it. Integer-only, so writer and reader agree exactly.
+static GhostSample predict(const GhostSample& before, const GhostSample& last, uint32_t index, uint64_t tick) {
+    GhostSample p;
+    p.tick = tick;
+    if (index == 0) return p;   // block keyframe, stored as is
+    p.x = last.x;
+    p.y = last.y;
+    p.heading = last.heading;
+    if (index == 1) return p;
+    const int64_t dt = int64_t(tick - last.tick), span = int64_t(last.tick - before.tick);
+    p.x += int32_t(int64_t(last.x - before.x) * dt / span);
+    p.y += int32_t(int64_t(last.y - before.y) * dt / span);
+    p.heading = uint16_t(p.heading + int64_t(int16_t(last.heading - before.heading)) * dt / span);
+    return p;
+}
+
+bool GhostWriter::begin(const std::string& path, int tickRate) {
+    abort();
+    file_ = std::fopen(path.c_str(), "wb");
+    if (!file_) return false;
+    path_ = path;
+    block_.clear();
+    block_.reserve(kBlockSamples * 12);   // residuals are a few bytes each
+    blockCount_ = 0;
+    samples_ = 0;
+    failed_ = false;
+
+    std::vector<uint8_t> header(kMagic, kMagic + 4);
+    header.push_back(kVersion);
+    putVarint(header, uint64_t(tickRate));
+    failed_ = std::fwrite(header.data(), 1, header.size(), file_) != header.size();
+    bytes_ = header.size();
+    return !failed_;
+}
+
+void GhostWriter::add(uint64_t tick, float x, float y, float headingDeg) {
+    if (!file_ || (samples_ > 0 && tick <= last_.tick)) return;
+
+    GhostSample s;
+    s.tick = tick;
+    s.x = int32_t(std::lround(x * kPosScale));
+    s.y = int32_t(std::lround(y * kPosScale));
+    const double turns = double(headingDeg) / 360.0;
+    s.heading = uint16_t(int64_t(std::llround((turns - std::floor(turns)) * 65536.0)));
+
+    if (blockCount_ == 0) blockStart_ = tick;
+    else                  putVarint(block_, tick - last_.tick);
+    const GhostSample p = predict(before_, last_, blockCount_, tick);
+    putSigned(block_, int64_t(s.x) - p.x);
+    putSigned(block_, int64_t(s.y) - p.y);
+    putSigned(block_, int16_t(uint16_t(s.heading - p.heading)));
+
+    before_ = last_;
+    last_ = s;
+    ++samples_;
+    if (++blockCount_ == kBlockSamples) flushBlock();
+}
+
+// Each full block goes straight to the file, so an interrupted run loses
+// at most one block and nothing piles up in memory.
+void GhostWriter::flushBlock() {
+    if (blockCount_ == 0) return;
+    std::vector<uint8_t>& b = block_;
+    const size_t payload = b.size();
+    putVarint(b, payload);
+    putVarint(b, blockCount_);
+    putVarint(b, blockStart_);
+    const size_t header = b.size() - payload;
+    failed_ |= std::fwrite(b.data() + payload, 1, header, file_) != header;
+    failed_ |= std::fwrite(b.data(), 1, payload, file_) != payload;
+    std::fflush(file_);
+    bytes_ += header + payload;
+    b.clear();
+    blockCount_ = 0;
+}
+
+bool GhostWriter::finish() {
+    if (!file_) return false;
+    flushBlock();
+    failed_ |= std::fclose(file_) != 0;
+    file_ = nullptr;
+    return !failed_;
+}
+
+void GhostWriter::abort() {
+    if (!file_) return;
+    std::fclose(file_);
+    file_ = nullptr;
+    std::error_code ec;
+    std::filesystem::remove(path_, ec);
+}
+
+bool Ghost::load(const std::string& path, int tickRate) {
+    data_.clear();
+    blocks_.clear();
+    primed_ = false;
+
+    FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f) return false;
+    std::fseek(f, 0, SEEK_END);
+    const long size = std::ftell(f);
+    std::fseek(f, 0, SEEK_SET);
+    if (size > 0) {
+        data_.resize(size_t(size));
+        data_.resize(std::fread(data_.data(), 1, data_.size(), f));
+    }
+    std::fclose(f);
+
+    size_t pos = 5;
+    uint64_t rate = 0;
+    if (data_.size() < pos || !std::equal(kMagic, kMagic + 4, data_.begin()) || data_[4] != kVersion ||
+        !getVarint(data_.data(), data_.size(), pos, rate) || rate != uint64_t(tickRate))
+        return false;
+
+    // index the blocks; a truncated last one (crash while writing) is ignored
+    while (pos < data_.size()) {
+        uint64_t bytes = 0, count = 0, start = 0;
+        if (!getVarint(data_.data(), data_.size(), pos, bytes) ||
+            !getVarint(data_.data(), data_.size(), pos, count) ||
+            !getVarint(data_.data(), data_.size(), pos, start) ||
+            bytes > data_.size() - pos || count == 0)
+            break;
+        blocks_.push_back({ start, uint32_t(pos), uint32_t(bytes), uint32_t(count) });
+        pos += bytes;
+    }
+    if (blocks_.empty()) return false;
+    data_.resize(pos);
+    data_.shrink_to_fit();
+    blocks_.shrink_to_fit();
+
+    // the last block's last sample is where the run ends
+    seekBlock(blocks_.size() - 1);
+    GhostSample s;
+    while (decode(s)) endTick_ = s.tick;
+    return true;
+}
+
+void Ghost::seekBlock(size_t i) {
+    block_ = i;
+    pos_ = blocks_[i].offset;
+    index_ = 0;
+}
+
+bool Ghost::decode(GhostSample& out) {
+    while (index_ == blocks_[block_].count) {
+        if (block_ + 1 == blocks_.size()) return false;
+        seekBlock(block_ + 1);
+    }
+    const Block& b = blocks_[block_];
+    const uint8_t* d = data_.data();
+    const size_t end = size_t(b.offset) + b.size;
+
+    uint64_t dt = 0;
+    if (index_ > 0 && (!getVarint(d, end, pos_, dt) || dt == 0)) return false;
+    const GhostSample p = predict(before_, last_, index_, index_ == 0 ? b.startTick : last_.tick + dt);
+    int64_t rx = 0, ry = 0, rh = 0;
+    if (!getSigned(d, end, pos_, rx) || !getSigned(d, end, pos_, ry) || !getSigned(d, end, pos_, rh))
+        return false;
+
+    out.tick = p.tick;
+    out.x = int32_t(p.x + rx);
+    out.y = int32_t(p.y + ry);
+    out.heading = uint16_t(p.heading + rh);
+    before_ = last_;
+    last_ = out;
+    ++index_;
+    return true;
+}
+
+void Ghost::seek(uint64_t tick) {
+    const auto it = std::upper_bound(blocks_.begin(), blocks_.end(), tick,
+                                     [](uint64_t t, const Block& b) { return t < b.startTick; });
+    seekBlock(it == blocks_.begin() ? 0 : size_t(it - blocks_.begin()) - 1);
+    primed_ = decode(cur_);
+    haveNext_ = primed_ && decode(next_);
+}
+
+bool Ghost::at(double tick, float& x, float& y, float& headingDeg) {
+    if (blocks_.empty() || tick > double(endTick_)) return false;
+    if (!primed_ || tick < double(cur_.tick)) seek(uint64_t(std::max(0.0, tick)));
+    if (!primed_) return false;
+    while (haveNext_ && double(next_.tick) <= tick) {
+        cur_ = next_;
+        haveNext_ = decode(next_);
+    }
+
+    float f = 0.f;
+    if (haveNext_ && tick > double(cur_.tick)) {
+        f = float((tick - double(cur_.tick)) / double(next_.tick - cur_.tick));
+        // a respawn is a jump, not a very fast drive: don't slide across it
+        const int64_t jump = std::max(std::abs(int64_t(next_.x) - cur_.x), std::abs(int64_t(next_.y) - cur_.y));
+        if (jump > int64_t(next_.tick - cur_.tick) * 32 * GhostWriter::kPosScale) f = 0.f;
+    }
+    const float dx = float(int64_t(next_.x) - cur_.x), dy = float(int64_t(next_.y) - cur_.y);
+    const float dh = float(int16_t(uint16_t(next_.heading - cur_.heading)));
+    x = (float(cur_.x) + dx * f) / GhostWriter::kPosScale;
+    y = (float(cur_.y) + dy * f) / GhostWriter::kPosScale;
+    headingDeg = (float(cur_.heading) + dh * f) * (360.f / 65536.f);
+    return true;
+}
@@ -0,0 +1,140 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Ghost trajectories: one car's position and heading every few ticks,
+// quantized to 1/kPosScale px and 1/65536 turn, stored as zigzag varint
+// residuals against a constant-velocity guess from the two samples before.
+// Samples are grouped in blocks whose first sample is absolute, so playback
+// can jump to any block and decode forward only as far as it needs.
+//
+// File: "BRGH", version byte, varint tick rate, then blocks of
+//   varint payload bytes, varint sample count, varint start tick, payload
+struct GhostSample {
+    uint64_t tick{0};
+    int32_t  x{0}, y{0};     // 1/kPosScale px
+    uint16_t heading{0};     // 1/65536 turn
+};
+
+// One step of a solo run as the simulation drives it: a sample of player 0,
+// or how the run ended.
+struct GhostEvent {
+    enum class Kind : uint8_t { Sample, Won, Lost };
+    Kind     kind{Kind::Sample};
+    uint64_t tick{0};
+    float    x{0.f}, y{0.f}, headingDeg{0.f};
+};
+
+// Lock-free single-producer / single-consumer FIFO, sim thread to the ghost
+// writer thread. Samples are taken on ticks, so their spacing does not
+// depend on the frame rate or on pauses.
+class GhostFeed {
+public:
+    static constexpr uint32_t kCapacity    = 1024;   // power of two; ~34 s of samples
+    static constexpr uint64_t kSampleTicks = 4;      // 30 Hz at 120 Hz ticks
+
+    // false when full (the writer has stalled on the disk); the event is lost
+    bool push(const GhostEvent& e) {
+        const uint32_t head = head_.load(std::memory_order_relaxed);
+        if (head - tail_.load(std::memory_order_acquire) == kCapacity) return false;
+        slots_[head & (kCapacity - 1)] = e;
+        head_.store(head + 1, std::memory_order_release);
+        wake();
+        return true;
+    }
+
+    bool pop(GhostEvent& out) {
+        const uint32_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail == head_.load(std::memory_order_acquire)) return false;
+        out = slots_[tail & (kCapacity - 1)];
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // consumer sleeps in wait(wakes()) until a push or wake() after it read wakes()
+    uint32_t wakes() const { return wake_.load(std::memory_order_acquire); }
+    void wait(uint32_t seen) const { wake_.wait(seen, std::memory_order_acquire); }
+    void wake() {
+        wake_.fetch_add(1, std::memory_order_release);
+        wake_.notify_one();
+    }
+
+private:
+    static_assert((kCapacity & (kCapacity - 1)) == 0, "kCapacity must be a power of two");
+    std::array<GhostEvent, kCapacity> slots_{};
+    alignas(64) std::atomic<uint32_t> head_{0};
+    alignas(64) std::atomic<uint32_t> tail_{0};
+    std::atomic<uint32_t> wake_{0};
+};
+
+// Appends a run to disk one block at a time while it is being driven.
+class GhostWriter {
+public:
+    static constexpr int      kPosScale     = 8;
+    static constexpr uint32_t kBlockSamples = 64;
+
+    GhostWriter() = default;
+    ~GhostWriter() { abort(); }
+    GhostWriter(const GhostWriter&) = delete;
+    GhostWriter& operator=(const GhostWriter&) = delete;
+
+    bool begin(const std::string& path, int tickRate);
+    void add(uint64_t tick, float x, float y, float headingDeg);   // ticks must increase
+    bool finish();   // flush and close; the file stays
+    void abort();    // close and delete
+    bool active() const { return file_ != nullptr; }
+
+    uint64_t samples() const { return samples_; }
+    uint64_t bytes() const { return bytes_; }
+
+private:
+    void flushBlock();
+
+    FILE*                file_{nullptr};
+    std::string          path_;
+    std::vector<uint8_t> block_;          // payload of the block being filled
+    uint32_t             blockCount_{0};
+    uint64_t             blockStart_{0};
+    GhostSample          before_, last_;  // prediction state within the block
+    uint64_t             samples_{0}, bytes_{0};
+    bool                 failed_{false};
+};
+
+// A recorded run held compressed in memory; at() decodes on demand.
+// Sequential playback decodes about one sample per call; going backwards
+// (retry, rewind) restarts from the nearest block.
+class Ghost {
+public:
+    bool load(const std::string& path, int tickRate);
+
+    // interpolated pose at `tick`; false once the run is over
+    bool at(double tick, float& x, float& y, float& headingDeg);
+
+    uint64_t endTick() const { return endTick_; }
+    size_t   bytes() const { return data_.capacity() + blocks_.capacity() * sizeof(Block); }
+
+private:
+    struct Block {
+        uint64_t startTick;
+        uint32_t offset, size, count;
+    };
+
+    void seekBlock(size_t i);
+    void seek(uint64_t tick);
+    bool decode(GhostSample& out);   // next sample, crossing into the next block
+
+    std::vector<uint8_t> data_;
+    std::vector<Block>   blocks_;
+    uint64_t             endTick_{0};
+
+    // decode cursor
+    size_t      block_{0}, pos_{0};
+    uint32_t    index_{0};            // of the next sample within its block
+    GhostSample before_, last_;       // prediction state
+    GhostSample cur_, next_;          // samples bracketing the playback tick
+    bool        primed_{false}, haveNext_{false};
+};
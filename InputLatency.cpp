@@ -0,0 +1,72 @@
+#include "InputLatency.h"
+#include "Log.h"
+#include <algorithm>
+#include <string_view>
+
+void InputLatency::sent(uint64_t seq, uint64_t timeNs) {
+    if (head_ - tail_ == kPending) ++tail_;   // the sim has not caught up in ages; drop the oldest
+    pending_[head_++ & (kPending - 1)] = { seq, timeNs };
+}
+
+void InputLatency::presented(uint64_t appliedSeq, uint64_t nowNs) {
+    while (tail_ != head_) {
+        const Pending& p = pending_[tail_ & (kPending - 1)];
+        if (p.seq > appliedSeq) break;
+        const double ms = nowNs > p.timeNs ? double(nowNs - p.timeNs) * 1e-6 : 0.0;
+        const int b = std::min(kBuckets - 1, int(ms / double(kBucketMs)));
+        ++hist_[b];
+        minMs_ = count_ ? std::min(minMs_, ms) : ms;
+        maxMs_ = std::max(maxMs_, ms);
+        sumMs_ += ms;
+        ++count_;
+        ++tail_;
+    }
+}
+
+void InputLatency::reset() {
+    hist_.fill(0);
+    count_ = 0;
+    sumMs_ = minMs_ = maxMs_ = 0.0;
+    tail_ = head_;
+}
+
+double InputLatency::percentileMs(double p) const {
+    if (count_ == 0) return 0.0;
+    const uint64_t rank = std::max<uint64_t>(1, uint64_t(p * double(count_) + 0.5));
+    uint64_t seen = 0;
+    for (int b = 0; b < kBuckets; ++b) {
+        seen += hist_[b];
+        if (seen >= rank) return double(b + 1) * kBucketMs;
+    }
+    return maxMs_;
+}
+
+void InputLatency::report(const char* label) const {
+    if (count_ == 0) {
+        BR_LOG_INFO("Input latency ({}): no samples", std::string_view(label));
+        return;
+    }
+    BR_LOG_INFO("Input latency ({}): {} samples, mean {} ms, min {} ms",
+                std::string_view(label), count_, sumMs_ / double(count_), minMs_);
+    BR_LOG_INFO("  p50 {} ms, p95 {} ms, p99 {} ms, max {} ms",
+                percentileMs(0.50), percentileMs(0.95), percentileMs(0.99), maxMs_);
+
+    // 2 ms rows up to the slowest sample
+    constexpr int kPerRow = 4;
+    static constexpr char kBar[] = "########################################";
+    constexpr int kBarMax = int(sizeof kBar) - 1;
+    const int lastRow = std::min(kBuckets - 1, int(maxMs_ / double(kBucketMs))) / kPerRow;
+    uint64_t peak = 1;
+    for (int r = 0; r <= lastRow; ++r) {
+        uint64_t n = 0;
+        for (int b = r * kPerRow; b < std::min(kBuckets, (r + 1) * kPerRow); ++b) n += hist_[b];
+        peak = std::max(peak, n);
+    }
+    for (int r = 0; r <= lastRow; ++r) {
+        uint64_t n = 0;
+        for (int b = r * kPerRow; b < std::min(kBuckets, (r + 1) * kPerRow); ++b) n += hist_[b];
+        if (n == 0) continue;
+        const int bar = std::max(1, int(n * kBarMax / peak));
+        BR_LOG_INFO("  {} ms+ {} {}", float(r * kPerRow) * kBucketMs, n, std::string_view(kBar, size_t(bar)));
+    }
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include <array>
+#include <cstdint>
+
+// Input-to-present latency. The render thread notes every input event it
+// hands to the simulation, then after each SDL_RenderPresent reports the
+// newest event the presented snapshot included; everything up to it gets
+// a sample of (present time - event timestamp). Samples go into a
+// histogram of kBucketMs-wide buckets.
+class InputLatency {
+public:
+    static constexpr float kBucketMs = 0.5f;
+    static constexpr int   kBuckets  = 200;   // last bucket collects everything above
+
+    void sent(uint64_t seq, uint64_t timeNs);
+    void presented(uint64_t appliedSeq, uint64_t nowNs);
+
+    void reset();
+    void skipPending() { tail_ = head_; }   // e.g. on pause: don't time input across it
+    uint64_t samples() const { return count_; }
+    double percentileMs(double p) const;   // bucket upper edge
+    void report(const char* label) const;
+
+private:
+    struct Pending { uint64_t seq, timeNs; };
+    static constexpr uint32_t kPending = 64;   // power of two; oldest are forgotten
+
+    std::array<Pending, kPending>   pending_{};
+    uint32_t                        head_{0}, tail_{0};
+    std::array<uint32_t, kBuckets>  hist_{};
+    uint64_t                        count_{0};
+    double                          sumMs_{0.0}, minMs_{0.0}, maxMs_{0.0};
+};
@@ -0,0 +1,44 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+// One player's controls changing at a point in time. timeNs is the SDL event
+// timestamp (SDL_GetTicksNS clock); seq counts events so the render side can
+// tell which ones a published tick has consumed.
+struct InputEvent {
+    uint64_t timeNs{0};
+    uint64_t seq{0};
+    int      player{0};
+    float    throttle{0.f}, brake{0.f}, steer{0.f};
+};
+
+// Lock-free single-producer / single-consumer FIFO of input events, main
+// thread to sim thread. The consumer peeks so it can leave events that
+// belong to a later tick where they are.
+class InputQueue {
+public:
+    static constexpr uint32_t kCapacity = 256;   // power of two
+
+    // false when full (the sim thread has stalled for a long time)
+    bool push(const InputEvent& e) {
+        const uint32_t head = head_.load(std::memory_order_relaxed);
+        if (head - tail_.load(std::memory_order_acquire) == kCapacity) return false;
+        slots_[head & (kCapacity - 1)] = e;
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    const InputEvent* peek() const {
+        const uint32_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail == head_.load(std::memory_order_acquire)) return nullptr;
+        return &slots_[tail & (kCapacity - 1)];
+    }
+    void pop() { tail_.store(tail_.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+private:
+    static_assert((kCapacity & (kCapacity - 1)) == 0, "kCapacity must be a power of two");
+    std::array<InputEvent, kCapacity> slots_{};
+    alignas(64) std::atomic<uint32_t> head_{0};
+    alignas(64) std::atomic<uint32_t> tail_{0};
+};
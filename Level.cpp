@@ -0,0 +1,146 @@
+#include "Level.h"
+#include "Log.h"
+#include <SDL3/SDL.h>
+#include <algorithm>
+#include <filesystem>
+
+// Charged to the map in the heap pool; what each level puts in it shows up
+// per subsystem in the arena pool.
+static std::unique_ptr<std::byte[]> reserveArena(size_t bytes) {
+    brmem::Scope scope(MemTag::Map);
+    return std::unique_ptr<std::byte[]>(new std::byte[bytes]);
+}
+
+Level::Level(size_t arenaBytes)
+: capacity_(arenaBytes),
+  buffer_(reserveArena(arenaBytes)),
+  arena_(buffer_.get(), arenaBytes, &overflow_)
+{
+}
+
+std::vector<std::string> Level::discover(const std::string& dir) {
+    std::vector<std::string> out;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(dir, ec)) {
+        if (entry.is_regular_file() && entry.path().extension() == ".txt")
+            out.push_back(entry.path().generic_string());
+    }
+    if (ec) BR_LOG_WARN("Cannot list levels in {}: {}", dir, ec.message());
+    std::sort(out.begin(), out.end());
+    return out;
+}
+
+void Level::unload() {
+    // containers first: their storage is about to vanish with the arena
+    vis_.reset();
+    pvs_.reset();
+    nav_.reset();
+    map_.reset();
+    arena_.release();
+    counter_.resetCounts();
+    overflow_.resetCounts();
+    start_ = WorldState{};
+    path_.clear();
+}
+
+bool Level::load(const std::string& path, int tile, std::string* error) {
+    unload();
+    brmem::Scope scope(MemTag::Loader);   // heap side: file streams, path strings
+    const Uint64 t0 = SDL_GetPerformanceCounter();
+
+    map_.emplace(&mapMem_);
+    nav_.emplace(&navMem_);
+    {
+        // rows live in the arena too; they are only dead weight until the next unload
+        LevelLines lines(&loaderMem_);
+        if (!Map::readLevelLines(path, lines, error) || !map_->loadFromLines(lines, tile, error)) {
+            unload();
+            return false;
+        }
+        scanMarkers(lines);
+    }
+    nav_->build(*map_);
+    const Uint64 pvsT0 = SDL_GetPerformanceCounter();
+    pvs_.emplace(&pvsMem_);
+    pvs_->build(*map_);
+    const double pvsMs = double(SDL_GetPerformanceCounter() - pvsT0) * 1000.0 / double(SDL_GetPerformanceFrequency());
+    vis_.emplace(&fogMem_);
+    vis_->reset(*map_);
+    path_ = path;
+
+    const double ms = double(SDL_GetPerformanceCounter() - t0) * 1000.0 / double(SDL_GetPerformanceFrequency());
+    BR_LOG_INFO("Level {}: {}x{} tiles, loaded in {} ms", path, map_->cols(), map_->rows(), ms);
+    BR_LOG_INFO("Level has {} flags, {} enemies, {} nav regions",
+                start_.flagCount, start_.enemyCount, nav_->regionCount());
+    BR_LOG_INFO("Level PVS: {} regions, {} of {} region pairs can see each other, built in {} ms",
+                pvs_->regionCount(), pvs_->visiblePairs(), pvs_->regionCount() * pvs_->regionCount(), pvsMs);
+    BR_LOG_INFO("Level arena: {} KiB in {} allocations ({} KiB reserved)",
+                counter_.bytes() / 1024, counter_.allocations(), capacity_ / 1024);
+    if (overflow_.bytes() > 0)
+        BR_LOG_WARN("Level {} outgrew its arena by {} KiB", path, overflow_.bytes() / 1024);
+    return true;
+}
+
+// Markers sit on the same rows the map was built from: 'P' player spawn
+// (one per split-screen player, in reading order), 'E' enemy, 'F' flag.
+// Markers on solid tiles are ignored.
+void Level::scanMarkers(const LevelLines& lines) {
+    const int T = map_->tileSize();
+    std::array<SDL_FPoint, WorldState::kMaxPlayers> spawns{};
+    int spawnCount = 0;
+
+    for (int row = 0; row < int(lines.size()); ++row) {
+        const auto& line = lines[row];
+        for (int col = 0; col < int(line.size()); ++col) {
+            const char ch = line[col];
+            if (ch != 'P' && ch != 'E' && ch != 'F') continue;
+            const float wx = col * T + T * 0.5f;
+            const float wy = row * T + T * 0.5f;
+            if (map_->isWallAtPixel(wx, wy)) continue;
+
+            if (ch == 'P') {
+                if (spawnCount < WorldState::kMaxPlayers) spawns[spawnCount++] = {wx, wy};
+            } else if (ch == 'E' && !start_.addEnemy(EnemyCar(wx, wy))) {
+                BR_LOG_WARN("Enemy limit ({}) reached, ignoring enemy at {},{}", WorldState::kMaxEnemies, row, col);
+            } else if (ch == 'F' && !start_.addFlag({wx, wy, false})) {
+                BR_LOG_WARN("Flag limit ({}) reached, ignoring flag at {},{}", WorldState::kMaxFlags, row, col);
+            }
+        }
+    }
+    if (spawnCount == 0) {
+        BR_LOG_WARN("No player spawn ('P'), starting in the middle of the map");
+        spawns[spawnCount++] = { map_->worldPixelWidth() * 0.5f, map_->worldPixelHeight() * 0.5f };
+    }
+
+    // Levels made for one player get the extra cars on free tiles near the
+    // first, found by a flood fill from it so none can start in a sealed room.
+    if (spawnCount < WorldState::kMaxPlayers) {
+        const int rows = map_->rows(), cols = map_->cols();
+        const int r0 = std::clamp(int(spawns[0].y) / T, 0, rows - 1), c0 = std::clamp(int(spawns[0].x) / T, 0, cols - 1);
+        std::pmr::vector<int> dist(size_t(rows) * cols, -1, &loaderMem_);
+        std::pmr::vector<int> queue(&loaderMem_);
+        queue.push_back(r0 * cols + c0);
+        dist[queue[0]] = 0;
+        for (size_t qi = 0; qi < queue.size() && spawnCount < WorldState::kMaxPlayers; ++qi) {
+            const int t = queue[qi], r = t / cols, c = t % cols;
+            const float x = c * T + T * 0.5f, y = r * T + T * 0.5f;
+            bool spaced = dist[t] >= 2;   // two tiles apart, like cars parked side by side
+            for (int i = 0; i < spawnCount && spaced; ++i)
+                spaced = std::abs(spawns[i].x - x) >= 2.f * T || std::abs(spawns[i].y - y) >= 2.f * T;
+            if (spaced && map_->clearanceAt(x, y) >= T * 0.5f) spawns[spawnCount++] = { x, y };
+
+            const int nr[4] = { r - 1, r + 1, r, r };
+            const int nc[4] = { c, c, c - 1, c + 1 };
+            for (int k = 0; k < 4; ++k) {
+                if (nr[k] < 0 || nc[k] < 0 || nr[k] >= rows || nc[k] >= cols) continue;
+                const int nt = nr[k] * cols + nc[k];
+                if (dist[nt] >= 0 || tileSolid(map_->tileAt(nr[k], nc[k]))) continue;
+                dist[nt] = dist[t] + 1;
+                queue.push_back(nt);
+            }
+        }
+    }
+    for (int i = 0; i < WorldState::kMaxPlayers; ++i)
+        start_.players[i] = Player(spawns[i % spawnCount].x, spawns[i % spawnCount].y, -90.f);
+    start_.playerCount = 1;
+}
@@ -0,0 +1,100 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <string>
+#include <vector>
+#include "Map.h"
+#include "MemoryStats.h"
+#include "NavGraph.h"
+#include "Pvs.h"
+#include "Visibility.h"
+#include "WorldState.h"
+
+// Forwards to another resource and keeps a running total of what was asked
+// for, so per-level memory use can be logged and budgeted.
+class CountingResource : public std::pmr::memory_resource {
+public:
+    explicit CountingResource(std::pmr::memory_resource* upstream) : upstream_(upstream) {}
+
+    size_t bytes() const { return bytes_; }
+    size_t allocations() const { return allocations_; }
+    void resetCounts() { bytes_ = 0; allocations_ = 0; }
+
+private:
+    void* do_allocate(size_t bytes, size_t align) override {
+        bytes_ += bytes;
+        ++allocations_;
+        return upstream_->allocate(bytes, align);
+    }
+    void do_deallocate(void* p, size_t bytes, size_t align) override { upstream_->deallocate(p, bytes, align); }
+    bool do_is_equal(const std::pmr::memory_resource& o) const noexcept override { return this == &o; }
+
+    std::pmr::memory_resource* upstream_;
+    size_t bytes_{0};
+    size_t allocations_{0};
+};
+
+// One playable level: map, nav graph, PVS, fog of war and start state.
+// Everything the level allocates (file rows, tile grid, distance field, nav
+// graph and their build temporaries, visibility bits) comes from a single
+// monotonic arena carved out of a buffer reserved once per session.
+// Unloading drops the whole arena in one go, so switching levels neither
+// fragments the heap nor calls the allocator unless a level outgrows the
+// buffer.
+//
+// The arena is not thread-safe: load on the main thread once the previous
+// level's simulation is gone (it refers into the map, nav graph and PVS);
+// during play nothing allocates from it (nav query scratch and the
+// visibility bitsets are sized at load).
+class Level {
+public:
+    static constexpr size_t kArenaBytes = 4u << 20;
+
+    explicit Level(size_t arenaBytes = kArenaBytes);
+    ~Level() { unload(); }
+
+    Level(const Level&) = delete;
+    Level& operator=(const Level&) = delete;
+
+    // Sorted .txt files in dir.
+    static std::vector<std::string> discover(const std::string& dir);
+
+    bool load(const std::string& path, int tile, std::string* error = nullptr);
+    void unload();
+    bool loaded() const { return map_.has_value(); }
+
+    Map&              map()        { return *map_; }
+    const NavGraph&   nav() const  { return *nav_; }
+    const Pvs&        pvs() const  { return *pvs_; }   // enemy line-of-sight culling
+    Visibility&       visibility() { return *vis_; }   // render-side fog of war
+    const WorldState& start() const { return start_; }
+    const std::string& path() const { return path_; }
+
+    size_t arenaBytes() const    { return counter_.bytes(); }    // requested by this level
+    size_t overflowBytes() const { return overflow_.bytes(); }   // spilled past the buffer
+
+private:
+    void scanMarkers(const LevelLines& lines);
+
+    size_t                              capacity_;
+    std::unique_ptr<std::byte[]>        buffer_;
+    CountingResource                    overflow_{std::pmr::new_delete_resource()};
+    std::pmr::monotonic_buffer_resource arena_;
+    CountingResource                    counter_{&arena_};
+    // per-subsystem views of the arena for the memory report
+    TaggedResource                      loaderMem_{MemTag::Loader, &counter_};
+    TaggedResource                      mapMem_{MemTag::Map, &counter_};
+    TaggedResource                      navMem_{MemTag::Nav, &counter_};
+    TaggedResource                      fogMem_{MemTag::Fog, &counter_};
+    TaggedResource                      pvsMem_{MemTag::Pvs, &counter_};
+
+    std::optional<Map>        map_;
+    std::optional<NavGraph>   nav_;
+    std::optional<Pvs>        pvs_;
+    std::optional<Visibility> vis_;
+    WorldState                start_;
+    std::string               path_;
+};
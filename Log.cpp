@@ -0,0 +1,187 @@
+#include "Log.h"
+#include <SDL3/SDL.h>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
+
+namespace brlog {
+namespace {
+
+// Bounded multi-producer ring (Vyukov): each slot carries a sequence number
+// so producers claim slots with a single CAS and never wait on the consumer.
+struct Slot {
+    std::atomic<size_t> seq;
+    Record              rec;
+};
+
+struct Logger {
+    std::unique_ptr<Slot[]> slots;
+    alignas(64) std::atomic<size_t>   head{0};     // next slot producers claim
+    alignas(64) size_t                tail{0};     // consumer only
+    alignas(64) std::atomic<uint32_t> wake{0};
+    std::atomic<uint64_t> dropped{0};
+    std::atomic<bool>     running{false};
+    std::atomic<bool>     stopping{false};
+    std::thread           thread;
+    FILE*                 sink{stdout};
+};
+
+Logger g;
+
+constexpr size_t kMask = kQueueSlots - 1;
+static_assert((kQueueSlots & kMask) == 0, "kQueueSlots must be a power of two");
+
+const char* levelName(Level l) {
+    switch (l) {
+        case Level::Trace: return "TRACE";
+        case Level::Debug: return "DEBUG";
+        case Level::Info:  return "INFO ";
+        case Level::Warn:  return "WARN ";
+        case Level::Error: return "ERROR";
+    }
+    return "?    ";
+}
+
+// Expands "{}" placeholders in order; "{{" prints a literal brace.
+size_t format(const Record& r, char* out, size_t cap) {
+    size_t n = 0;
+    auto put = [&](int written) { if (written > 0) n = std::min(cap - 1, n + size_t(written)); };
+
+    put(std::snprintf(out, cap, "[%10.3f] %s ", double(r.timeNs) * 1e-9, levelName(r.level)));
+
+    int argi = 0;
+    for (const char* p = r.fmt; *p && n < cap - 1; ++p) {
+        if (p[0] == '{' && p[1] == '{') { out[n++] = '{'; ++p; continue; }
+        if (p[0] == '{' && p[1] == '}' && argi < kMaxArgs) {
+            const Arg& a = r.args[argi];
+            char* dst = out + n;
+            const size_t room = cap - n;
+            switch (r.kinds[argi]) {
+                case Arg::Kind::Int:   put(std::snprintf(dst, room, "%lld", a.i)); break;
+                case Arg::Kind::UInt:  put(std::snprintf(dst, room, "%llu", a.u)); break;
+                case Arg::Kind::Float: put(std::snprintf(dst, room, "%.2f", a.f)); break;
+                case Arg::Kind::Str:   put(std::snprintf(dst, room, "%s", a.s ? a.s : "(null)")); break;
+                case Arg::Kind::Text:  put(std::snprintf(dst, room, "%s", r.text + a.text)); break;
+                case Arg::Kind::None:  put(std::snprintf(dst, room, "{}")); break;
+            }
+            ++argi; ++p;
+            continue;
+        }
+        out[n++] = *p;
+    }
+    out[n++] = '\n';
+    return n;
+}
+
+bool pop(Record& out) {
+    Slot& s = g.slots[g.tail & kMask];
+    if (s.seq.load(std::memory_order_acquire) != g.tail + 1) return false;
+    out = s.rec;
+    s.seq.store(g.tail + kQueueSlots, std::memory_order_release);
+    ++g.tail;
+    return true;
+}
+
+void drain() {
+    char line[512];
+    Record rec;
+    uint64_t reportedDrops = 0;
+
+    for (;;) {
+        const uint32_t seen = g.wake.load(std::memory_order_acquire);
+        bool any = false;
+        while (pop(rec)) {
+            std::fwrite(line, 1, format(rec, line, sizeof line), g.sink);
+            any = true;
+        }
+        const uint64_t d = g.dropped.load(std::memory_order_relaxed);
+        if (d != reportedDrops) {
+            std::fprintf(g.sink, "[log] %llu records dropped (ring full)\n", (unsigned long long)(d - reportedDrops));
+            reportedDrops = d;
+            any = true;
+        }
+        if (any) std::fflush(g.sink);
+        if (g.stopping.load(std::memory_order_acquire)) {
+            if (!pop(rec)) break;
+            std::fwrite(line, 1, format(rec, line, sizeof line), g.sink);
+            continue;
+        }
+        g.wake.wait(seen, std::memory_order_acquire);
+    }
+    std::fflush(g.sink);
+}
+
+} // namespace
+
+void init(FILE* sink) {
+    if (g.running.load()) return;
+    g.sink = sink ? sink : stdout;
+    if (!g.slots) {
+        g.slots.reset(new Slot[kQueueSlots]);
+        for (size_t i = 0; i < size_t(kQueueSlots); ++i) g.slots[i].seq.store(i, std::memory_order_relaxed);
+    }
+    g.stopping = false;
+    g.running = true;
+    g.thread = std::thread(drain);
+}
+
+void shutdown() {
+    if (!g.running.exchange(false)) return;
+    g.stopping.store(true, std::memory_order_release);
+    g.wake.fetch_add(1, std::memory_order_release);
+    g.wake.notify_one();
+    if (g.thread.joinable()) g.thread.join();
+
+    // A producer that saw `running` before it went false can still publish
+    // after the writer's last pop: wait out every claimed slot and write it
+    // here. Later records go through writeSync.
+    char line[512];
+    Record rec;
+    while (g.tail != g.head.load(std::memory_order_acquire)) {
+        if (pop(rec)) std::fwrite(line, 1, format(rec, line, sizeof line), g.sink);
+        else          std::this_thread::yield();   // claimed, not yet published
+    }
+    std::fflush(g.sink);
+}
+
+uint64_t dropped() { return g.dropped.load(std::memory_order_relaxed); }
+
+namespace detail {
+
+uint64_t nowNs() { return SDL_GetTicksNS(); }
+
+static void writeSync(const Record& rec) {
+    char line[512];
+    std::fwrite(line, 1, format(rec, line, sizeof line), g.sink);
+    std::fflush(g.sink);
+}
+
+bool push(const Record& rec) {
+    if (!g.running.load(std::memory_order_acquire)) { writeSync(rec); return true; }
+
+    size_t pos = g.head.load(std::memory_order_relaxed);
+    for (;;) {
+        Slot& s = g.slots[pos & kMask];
+        const size_t seq = s.seq.load(std::memory_order_acquire);
+        const intptr_t diff = intptr_t(seq) - intptr_t(pos);
+        if (diff == 0) {
+            if (g.head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                s.rec = rec;
+                s.seq.store(pos + 1, std::memory_order_release);
+                break;
+            }
+        } else if (diff < 0) {
+            g.dropped.fetch_add(1, std::memory_order_relaxed); // full: never block the frame
+            return false;
+        } else {
+            pos = g.head.load(std::memory_order_relaxed);
+        }
+    }
+    g.wake.fetch_add(1, std::memory_order_release);
+    g.wake.notify_one();
+    return true;
+}
+
+} // namespace detail
+} // namespace brlog
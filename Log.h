@@ -0,0 +1,116 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+// Asynchronous, allocation-free logger.
+//
+// Call sites push fixed-size binary records (a static format string plus up
+// to kMaxArgs raw argument values) into a lock-free ring; a background thread
+// formats them and writes to the sink. Format strings use "{}" placeholders
+// and must be string literals. std::string / string_view arguments are copied
+// into the record, const char* arguments must outlive the process (literals).
+//
+// Levels below BR_LOG_MIN_LEVEL compile to nothing, arguments included.
+
+#ifndef BR_LOG_MIN_LEVEL
+#define BR_LOG_MIN_LEVEL 1 // Debug
+#endif
+
+namespace brlog {
+
+enum class Level : uint8_t { Trace = 0, Debug = 1, Info = 2, Warn = 3, Error = 4 };
+
+constexpr bool enabled(Level l) { return int(l) >= BR_LOG_MIN_LEVEL; }
+
+constexpr int kMaxArgs    = 4;
+constexpr int kTextBytes  = 56;     // inline copies of string arguments
+constexpr int kQueueSlots = 4096;   // power of two
+
+struct Arg {
+    enum class Kind : uint8_t { None, Int, UInt, Float, Str, Text };
+    union {
+        long long          i;
+        unsigned long long u;
+        double             f;
+        const char*        s;
+        uint32_t           text; // offset into Record::text
+    };
+};
+
+struct Record {
+    uint64_t    timeNs;
+    const char* fmt;
+    Arg         args[kMaxArgs];
+    Arg::Kind   kinds[kMaxArgs];
+    Level       level;
+    uint8_t     textUsed;
+    char        text[kTextBytes];
+};
+
+// Start / stop the drain thread. Records logged while it is not running are
+// formatted synchronously, so early start-up messages are never lost.
+void init(FILE* sink = stdout);
+void shutdown();
+
+// Records dropped because the ring was full.
+uint64_t dropped();
+
+namespace detail {
+    bool push(const Record& rec);
+    uint64_t nowNs();
+
+    inline void pack(Record& r, int i, bool v)               { r.kinds[i] = Arg::Kind::Int;   r.args[i].i = v; }
+    inline void pack(Record& r, int i, const char* v)        { r.kinds[i] = Arg::Kind::Str;   r.args[i].s = v; }
+    inline void pack(Record& r, int i, std::string_view v) {
+        const size_t room = size_t(kTextBytes - r.textUsed);
+        const size_t n = v.size() < room ? v.size() : (room ? room - 1 : 0);
+        r.kinds[i] = Arg::Kind::Text;
+        // out of room: point at the previous argument's terminator, an empty string
+        r.args[i].text = room ? r.textUsed : uint32_t(kTextBytes - 1);
+        for (size_t k = 0; k < n; ++k) r.text[r.textUsed + k] = v[k];
+        if (room) { r.text[r.textUsed + n] = '\0'; r.textUsed = uint8_t(r.textUsed + n + 1); }
+    }
+    inline void pack(Record& r, int i, const std::string& v) { pack(r, i, std::string_view(v)); }
+
+    template <typename T>
+    inline void pack(Record& r, int i, T v) {
+        if constexpr (std::is_enum_v<T>) {
+            pack(r, i, static_cast<std::underlying_type_t<T>>(v));
+        } else if constexpr (std::is_floating_point_v<T>) {
+            r.kinds[i] = Arg::Kind::Float; r.args[i].f = double(v);
+        } else if constexpr (std::is_signed_v<T>) {
+            r.kinds[i] = Arg::Kind::Int;   r.args[i].i = (long long)v;
+        } else {
+            static_assert(std::is_unsigned_v<T>, "unsupported log argument type");
+            r.kinds[i] = Arg::Kind::UInt;  r.args[i].u = (unsigned long long)v;
+        }
+    }
+}
+
+template <typename... Args>
+inline void write(Level level, const char* fmt, const Args&... args) {
+    static_assert(sizeof...(Args) <= kMaxArgs, "too many log arguments");
+    Record r;
+    r.timeNs = detail::nowNs();
+    r.fmt = fmt;
+    r.level = level;
+    r.textUsed = 0;
+    for (auto& k : r.kinds) k = Arg::Kind::None;
+    int i = 0;
+    (detail::pack(r, i++, args), ...);
+    detail::push(r);
+}
+
+} // namespace brlog
+
+#define BR_LOG(level, ...) \
+    do { if constexpr (brlog::enabled(level)) brlog::write(level, __VA_ARGS__); } while (0)
+
+#define BR_LOG_TRACE(...) BR_LOG(brlog::Level::Trace, __VA_ARGS__)
+#define BR_LOG_DEBUG(...) BR_LOG(brlog::Level::Debug, __VA_ARGS__)
+#define BR_LOG_INFO(...)  BR_LOG(brlog::Level::Info,  __VA_ARGS__)
+#define BR_LOG_WARN(...)  BR_LOG(brlog::Level::Warn,  __VA_ARGS__)
+#define BR_LOG_ERROR(...) BR_LOG(brlog::Level::Error, __VA_ARGS__)
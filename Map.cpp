@@ -1,27 +1,21 @@
 #include "Map.h"
 #include "Camera.h"
+#include "MemoryStats.h"
+#include "RenderQueue.h"
+#include "Visibility.h"
 #include <fstream>
 #include <string>
 #include <algorithm>
 #include <cmath>
 
-// Legend (extend anytime):
-//   '#' => wall
-//   '.' => empty
-//   ' ' => empty
-//   (everything else defaults to empty)
-uint8_t Map::decodeTile(char ch)
-{
-    switch (ch)
-    {
-        case '#': return 1;
-        case '.': return 0;
-        case ' ': return 0;
-        default:  return 0;
-    }
-}
+// Legend and per-type properties live in TileTypes.h (kTileInfo):
+//   '#' => wall       'd' => dirt (slow)
+//   'x' => fence (solid, see-through)
+//   everything else (including '.', ' ', P/E/F markers) => empty
 
-Map::Map(const char* const* rowsCStr, int rows, int cols, int tile): rows_(rows), cols_(cols), tile_(tile), grid_(rows * cols, 0)
+Map::Map(std::pmr::memory_resource* mem): grid_(mem), field_(mem) {}
+
+Map::Map(const char* const* rowsCStr, int rows, int cols, int tile): rows_(rows), cols_(cols), tile_(tile), grid_(rows * cols, TileType::Empty)
 {
     for (int r = 0; r < rows_; ++r)
     {
@@ -31,9 +25,10 @@ Map::Map(const char* const* rowsCStr, int rows, int cols, int tile): rows_(rows)
             grid_[r * cols_ + c] = decodeTile(line[c]);
         }
     }
+    buildField();
 }
 
-bool Map::loadFromFile(const std::string& path, int tile, std::string* error)
+bool Map::readLevelLines(const std::string& path, LevelLines& out, std::string* error)
 {
     std::ifstream in(path);
     if (!in)
@@ -42,21 +37,37 @@ bool Map::loadFromFile(const std::string& path, int tile, std::string* error)
         return false;
     }
 
-    std::vector<std::string> lines;
-    std::string line;
+    out.clear();
+    std::pmr::string line(out.get_allocator());
     while (std::getline(in, line))
     {
         if (!line.empty() && line.back() == '\r') line.pop_back();
         // Skip lines starting with ';' or '//'
         if (!line.empty() && (line[0] == ';' || (line.size() >= 2 && line[0] == '/' && line[1] == '/')))
             continue;
-        if (!line.empty()) lines.push_back(line);
+        if (!line.empty()) out.emplace_back(line);
     }
-    if (lines.empty())
+    if (out.empty())
     {
         if (error) *error = "File had no map lines: " + path;
         return false;
     }
+    return true;
+}
+
+bool Map::loadFromFile(const std::string& path, int tile, std::string* error)
+{
+    LevelLines lines(grid_.get_allocator());
+    return readLevelLines(path, lines, error) && loadFromLines(lines, tile, error);
+}
+
+bool Map::loadFromLines(LevelLines& lines, int tile, std::string* error)
+{
+    if (lines.empty())
+    {
+        if (error) *error = "No map lines";
+        return false;
+    }
 
     // Determine width
     size_t maxW = 0;
@@ -66,15 +77,73 @@ bool Map::loadFromFile(const std::string& path, int tile, std::string* error)
     rows_ = static_cast<int>(lines.size());
     cols_ = static_cast<int>(maxW);
     tile_ = tile;
-    grid_.assign(rows_ * cols_, 0);
+    grid_.assign(rows_ * cols_, TileType::Empty);
 
     for (int r = 0; r < rows_; ++r)
         for (int c = 0; c < cols_; ++c)
             grid_[r * cols_ + c] = decodeTile(lines[r][c]);
 
+    buildField();
     return true;
 }
 
+void Map::drawTile(SDL_Renderer* r, TileSprite sprite, const SDL_FRect& fr) const
+{
+    if (SDL_Texture* tex = tileTex_[size_t(sprite)]) {
+        SDL_RenderTexture(r, tex, nullptr, &fr);
+        return;
+    }
+    switch (sprite)
+    {
+        case TileSprite::Wall:
+            SDL_SetRenderDrawColor(r, 0, 255, 0, 255);   // fill green
+            SDL_RenderFillRect(r, &fr);
+            SDL_SetRenderDrawColor(r, 255, 165, 0, 255); // border orange
+            SDL_RenderRect(r, &fr);
+            break;
+        case TileSprite::Dirt:
+            SDL_SetRenderDrawColor(r, 120, 84, 48, 255);
+            SDL_RenderFillRect(r, &fr);
+            break;
+        case TileSprite::Fence:
+            SDL_SetRenderDrawColor(r, 170, 170, 170, 255);
+            SDL_RenderRect(r, &fr);
+            break;
+        default:
+            break;
+    }
+}
+
+// remembered-but-unseen tiles are drawn at 40% brightness
+static inline SDL_Color shade(SDL_Color c, bool dim)
+{
+    if (!dim) return c;
+    return { Uint8(c.r * 2 / 5), Uint8(c.g * 2 / 5), Uint8(c.b * 2 / 5), c.a };
+}
+
+void Map::queueTile(RenderQueue& q, TileSprite sprite, const SDL_FRect& fr, bool dim) const
+{
+    if (SDL_Texture* tex = tileTex_[size_t(sprite)]) {
+        q.sprite(RenderLayer::Map, tex, fr, 0.f, shade({255, 255, 255, 255}, dim));
+        return;
+    }
+    switch (sprite)
+    {
+        case TileSprite::Wall:
+            q.fillRect(RenderLayer::Map, fr, shade({0, 255, 0, 255}, dim));      // fill green
+            q.outlineRect(RenderLayer::Map, fr, shade({255, 165, 0, 255}, dim)); // border orange
+            break;
+        case TileSprite::Dirt:
+            q.fillRect(RenderLayer::Map, fr, shade({120, 84, 48, 255}, dim));
+            break;
+        case TileSprite::Fence:
+            q.outlineRect(RenderLayer::Map, fr, shade({170, 170, 170, 255}, dim));
+            break;
+        default:
+            break;
+    }
+}
+
 void Map::render(SDL_Renderer* r) const
 {
     int w = 0, h = 0;
@@ -82,28 +151,29 @@ void Map::render(SDL_Renderer* r) const
     const int endCol = std::min(cols_ - 1, (w + tile_ - 1) / tile_);
     const int endRow = std::min(rows_ - 1, (h + tile_ - 1) / tile_);
 
-    SDL_SetRenderDrawColor(r, 0, 255, 0, 255);
     for (int y = 0; y <= endRow; ++y)
     {
         for (int x = 0; x <= endCol; ++x)
         {
-            if (at(y, x) == 1)
+            const TileSprite sprite = tileSprite(at(y, x));
+            if (sprite != TileSprite::None)
             {
                 SDL_FRect fr{ float(x * tile_), float(y * tile_), float(tile_), float(tile_) };
-
-                // Fill green
-                SDL_SetRenderDrawColor(r, 0, 255, 0, 255);
-                SDL_RenderFillRect(r, &fr);
-
-                // Draw border orange
-                SDL_SetRenderDrawColor(r, 255, 165, 0, 255);
-                SDL_RenderRect(r, &fr);
+                drawTile(r, sprite, fr);
             }
         }
     }
 }
 
-void Map::render(SDL_Renderer* r, const Camera& cam) const
+static bool inAnyView(std::span<const SDL_FRect> views, float x, float y, float size)
+{
+    for (const SDL_FRect& v : views)
+        if (x < v.x + v.w && x + size > v.x && y < v.y + v.h && y + size > v.y) return true;
+    return false;
+}
+
+void Map::render(RenderQueue& q, const Camera& cam, const Visibility* vis,
+                 std::span<const SDL_FRect> views) const
 {
     // Compute visible tile range
     int firstCol = std::max(0, int(std::floor(cam.view.x / tile_)));
@@ -115,34 +185,206 @@ void Map::render(SDL_Renderer* r, const Camera& cam) const
     {
         for (int x = firstCol; x <= lastCol; ++x)
         {
-            if (at(y, x) == 1)
-            {
-                // Subtract camera to draw in screen space
-                SDL_FRect fr{
-                    float(x * tile_) - cam.view.x,
-                    float(y * tile_) - cam.view.y,
-                    float(tile_), float(tile_)
-                };
-
-                SDL_SetRenderDrawColor(r, 0, 255, 0, 255);   // fill green
-                SDL_RenderFillRect(r, &fr);
-
-                SDL_SetRenderDrawColor(r, 255, 165, 0, 255); // border orange
-                SDL_RenderRect(r, &fr);
-            }
+            const TileSprite sprite = tileSprite(at(y, x));
+            if (sprite == TileSprite::None) continue;
+            if (vis && !vis->explored(y, x)) continue;
+            if (!views.empty() && !inAnyView(views, float(x * tile_), float(y * tile_), float(tile_))) continue;
+
+            // Subtract camera to draw in screen space
+            SDL_FRect fr{
+                float(x * tile_) - cam.view.x,
+                float(y * tile_) - cam.view.y,
+                float(tile_), float(tile_)
+            };
+            queueTile(q, sprite, fr, vis && !vis->visible(y, x));
         }
     }
 }
 
-bool Map::isWallAtPixel(float px, float py) const
+// Outside the grid counts as wall, so it is solid and opaque.
+TileType Map::tileAtPixel(float px, float py) const
 {
     const int cx = int(std::floor(px / tile_));
     const int cy = int(std::floor(py / tile_));
-    if (!inBounds(cy, cx)) return true;
-    return at(cy, cx) == 1;
+    if (!inBounds(cy, cx)) return TileType::Wall;
+    return at(cy, cx);
+}
+
+bool Map::isWallAtPixel(float px, float py) const
+{
+    return tileSolid(tileAtPixel(px, py));
+}
+
+bool Map::blocksSightAtPixel(float px, float py) const
+{
+    return tileOpaque(tileAtPixel(px, py));
+}
+
+// Walks every tile whose interior the segment enters; exactly through a
+// corner it steps diagonally.
+bool Map::lineOfSight(float ax, float ay, float bx, float by) const
+{
+    const double x0 = double(ax) / tile_, y0 = double(ay) / tile_;
+    const double x1 = double(bx) / tile_, y1 = double(by) / tile_;
+    int c = int(std::floor(x0)), r = int(std::floor(y0));
+    const int ec = int(std::floor(x1)), er = int(std::floor(y1));
+    const double dx = x1 - x0, dy = y1 - y0;
+    const int sc = dx > 0 ? 1 : -1, sr = dy > 0 ? 1 : -1;
+    // ray parameter at the next vertical and horizontal grid line
+    double tx = dx != 0 ? ((dx > 0 ? c + 1 : c) - x0) / dx : INFINITY;
+    double ty = dy != 0 ? ((dy > 0 ? r + 1 : r) - y0) / dy : INFINITY;
+    const double stepX = dx != 0 ? std::abs(1.0 / dx) : INFINITY;
+    const double stepY = dy != 0 ? std::abs(1.0 / dy) : INFINITY;
+    for (int left = std::abs(ec - c) + std::abs(er - r); ; --left) {
+        if (tileOpaque(tileAt(r, c))) return false;
+        if ((c == ec && r == er) || left <= 0) return true;
+        const double t = std::min(tx, ty);
+        if (tx == t) { c += sc; tx += stepX; }
+        if (ty == t) { r += sr; ty += stepY; }
+    }
+}
+
+float Map::frictionAtPixel(float px, float py) const
+{
+    return tileFriction(tileAtPixel(px, py));
+}
+
+void Map::setCell(int row, int col, TileType t)
+{
+    if (!inBounds(row, col) || at(row, col) == t) return;
+    const bool wasSolid = tileSolid(at(row, col));
+    at(row, col) = t;
+    if (wasSolid == tileSolid(t) || field_.empty()) return;
+
+    // only samples within the clearance cap of this tile can change
+    const int reach = kFieldMaxTiles * kFieldRes + 1;
+    const int x0 = 1 + col * kFieldRes, y0 = 1 + row * kFieldRes;
+    brmem::Scope scope(MemTag::Map);
+    updateField(x0 - reach, y0 - reach, x0 + kFieldRes - 1 + reach, y0 + kFieldRes - 1 + reach,
+                std::pmr::get_default_resource());   // the level arena never frees: keep edits off it
+}
+
+// ---- wall distance field ----------------------------------------------------
+//
+// Exact Euclidean distance transform (Felzenszwalb & Huttenlocher): two
+// separable passes of a 1D lower-envelope transform, linear in sample count.
+// Each sample stores the distance from its centre to the nearest solid
+// sample centre minus half a sample, i.e. roughly the distance to the wall's
+// surface, capped at maxClearance().
+
+static constexpr float kFar = 1e20f;   // "no wall seen yet"; finite keeps the maths simple
+
+static void edt1d(const float* f, int n, float* d, int* v, float* z)
+{
+    int k = 0;
+    v[0] = 0;
+    z[0] = -kFar;
+    z[1] = kFar;
+    for (int q = 1; q < n; ++q)
+    {
+        float s = ((f[q] + float(q) * q) - (f[v[k]] + float(v[k]) * v[k])) / (2.f * float(q - v[k]));
+        while (s <= z[k])
+        {
+            --k;
+            s = ((f[q] + float(q) * q) - (f[v[k]] + float(v[k]) * v[k])) / (2.f * float(q - v[k]));
+        }
+        ++k;
+        v[k] = q;
+        z[k] = s;
+        z[k + 1] = kFar;
+    }
+    k = 0;
+    for (int q = 0; q < n; ++q)
+    {
+        while (z[k + 1] < float(q)) ++k;
+        const float dq = float(q - v[k]);
+        d[q] = std::min(kFar, dq * dq + f[v[k]]);
+    }
+}
+
+void Map::buildField()
+{
+    fieldW_ = cols_ * kFieldRes + 2;
+    fieldH_ = rows_ * kFieldRes + 2;
+    field_.assign(size_t(fieldW_) * fieldH_, 0.f);
+    updateField(0, 0, fieldW_ - 1, fieldH_ - 1, field_.get_allocator().resource());
+}
+
+void Map::updateField(int x0, int y0, int x1, int y1, std::pmr::memory_resource* scratch)
+{
+    // distances inside the output window only depend on solids within the cap
+    const int reach = kFieldMaxTiles * kFieldRes + 1;
+    const int ix0 = std::max(0, x0 - reach), iy0 = std::max(0, y0 - reach);
+    const int ix1 = std::min(fieldW_ - 1, x1 + reach), iy1 = std::min(fieldH_ - 1, y1 + reach);
+    x0 = std::max(0, x0); y0 = std::max(0, y0);
+    x1 = std::min(fieldW_ - 1, x1); y1 = std::min(fieldH_ - 1, y1);
+    const int w = ix1 - ix0 + 1, h = iy1 - iy0 + 1;
+
+    std::pmr::vector<float> grid(size_t(w) * h, scratch);
+    const int n = std::max(w, h);
+    std::pmr::vector<float> f(n, scratch), d(n, scratch), z(n + 1, scratch);
+    std::pmr::vector<int> v(n, scratch);
+
+    // seed: 0 on solid samples (and the border ring), inf elsewhere
+    for (int y = 0; y < h; ++y)
+    {
+        for (int x = 0; x < w; ++x)
+        {
+            const int sx = ix0 + x, sy = iy0 + y;
+            bool solid = sx == 0 || sy == 0 || sx == fieldW_ - 1 || sy == fieldH_ - 1;
+            if (!solid) solid = tileSolid(at((sy - 1) / kFieldRes, (sx - 1) / kFieldRes));
+            grid[size_t(y) * w + x] = solid ? 0.f : kFar;
+        }
+    }
+    // columns, then rows
+    for (int x = 0; x < w; ++x)
+    {
+        for (int y = 0; y < h; ++y) f[y] = grid[size_t(y) * w + x];
+        edt1d(f.data(), h, d.data(), v.data(), z.data());
+        for (int y = 0; y < h; ++y) grid[size_t(y) * w + x] = d[y];
+    }
+    for (int y = 0; y < h; ++y)
+    {
+        edt1d(&grid[size_t(y) * w], w, d.data(), v.data(), z.data());
+        std::copy(d.begin(), d.begin() + w, grid.begin() + size_t(y) * w);
+    }
+
+    const float step = sampleSize();
+    const float cap = maxClearance();
+    for (int sy = y0; sy <= y1; ++sy)
+    {
+        for (int sx = x0; sx <= x1; ++sx)
+        {
+            const float dist = std::sqrt(grid[size_t(sy - iy0) * w + (sx - ix0)]) * step;
+            field_[size_t(sy) * fieldW_ + sx] = std::clamp(dist - step * 0.5f, 0.f, cap);
+        }
+    }
+}
+
+float Map::fieldAt(int sx, int sy) const
+{
+    sx = std::clamp(sx, 0, fieldW_ - 1);
+    sy = std::clamp(sy, 0, fieldH_ - 1);
+    return field_[size_t(sy) * fieldW_ + sx];
+}
+
+float Map::clearanceAt(float px, float py) const
+{
+    if (field_.empty()) return 0.f;
+    // padded sample space: sample (1,1) is centred on (step/2, step/2)
+    const float u = px / sampleSize() + 0.5f;
+    const float v = py / sampleSize() + 0.5f;
+    const float fu = std::floor(u), fv = std::floor(v);
+    const int x = int(fu), y = int(fv);
+    const float tx = u - fu, ty = v - fv;
+    const float top = fieldAt(x, y)     + (fieldAt(x + 1, y)     - fieldAt(x, y))     * tx;
+    const float bot = fieldAt(x, y + 1) + (fieldAt(x + 1, y + 1) - fieldAt(x, y + 1)) * tx;
+    return top + (bot - top) * ty;
 }
 
-void Map::setCell(int row, int col, uint8_t v)
+SDL_FPoint Map::clearanceGradientAt(float px, float py) const
 {
-    if (inBounds(row, col)) at(row, col) = v;
+    const float h = sampleSize();
+    return { (clearanceAt(px + h, py) - clearanceAt(px - h, py)) / (2.f * h),
+             (clearanceAt(px, py + h) - clearanceAt(px, py - h)) / (2.f * h) };
 }
\ No newline at end of file
@@ -2,18 +2,51 @@
 #include <SDL3/SDL.h>
 #include <vector>
 #include <cstdint>
+#include <memory_resource>
+#include <span>
 #include <string>
+#include "TileTypes.h"
 class Camera;
+class RenderQueue;
+class Visibility;
 
+// Level file rows with comments and blank lines stripped.
+using LevelLines = std::pmr::vector<std::pmr::string>;
+
+// Tile grid storage (and everything allocated while loading) comes from the
+// memory resource given at construction; see Level for the per-level arena.
 class Map {
 public:
-    Map() = default;
+    explicit Map(std::pmr::memory_resource* mem = std::pmr::get_default_resource());
     Map(const char* const* rowsCStr, int rows, int cols, int tile = 16);
     bool loadFromFile(const std::string& path, int tile, std::string* error = nullptr);
+    // Builds the grid from already-read rows; short rows are padded in place.
+    bool loadFromLines(LevelLines& lines, int tile, std::string* error = nullptr);
+    static bool readLevelLines(const std::string& path, LevelLines& out, std::string* error = nullptr);
     void render(SDL_Renderer* r) const;
-    void render(SDL_Renderer* r, const Camera& cam) const;
+    // with vis: unexplored tiles are skipped, explored but unseen ones dimmed
+    // views: world rects actually on screen (split-screen); tiles of cam.view
+    // outside all of them are skipped. Empty means all of cam.view.
+    void render(RenderQueue& q, const Camera& cam, const Visibility* vis = nullptr,
+                std::span<const SDL_FRect> views = {}) const;
     bool isWallAtPixel(float px, float py) const;
-    void setCell(int row, int col, uint8_t v);
+    bool blocksSightAtPixel(float px, float py) const;
+    // Exact: no opaque tile along the segment (grazing a corner is allowed).
+    bool lineOfSight(float ax, float ay, float bx, float by) const;
+    float frictionAtPixel(float px, float py) const;
+    TileType tileAtPixel(float px, float py) const;
+    TileType tileAt(int row, int col) const { return inBounds(row, col) ? at(row, col) : TileType::Wall; }
+    void setCell(int row, int col, TileType t);
+
+    // Distance from (px,py) to the nearest solid tile (or the map edge), in
+    // pixels, capped at maxClearance(). Read from a precomputed distance
+    // field, bilinearly filtered; within clearanceSlack() of the exact value.
+    float clearanceAt(float px, float py) const;
+    // Gradient of clearanceAt: points away from the nearest walls, ~unit length.
+    SDL_FPoint clearanceGradientAt(float px, float py) const;
+    float clearanceSlack() const { return sampleSize(); }
+    float maxClearance() const { return float(kFieldMaxTiles * tile_); }
+    void setTileTexture(TileSprite sprite, SDL_Texture* tex) { tileTex_[size_t(sprite)] = tex; }
     int rows() const { return rows_; }
     int cols() const { return cols_; }
     int tileSize() const { return tile_; }
@@ -22,10 +55,24 @@ public:
     bool loaded() const { return !grid_.empty(); }
 
 private:
+    static constexpr int kFieldRes = 4;        // field samples per tile edge
+    static constexpr int kFieldMaxTiles = 4;   // clearance cap, keeps setCell updates local
+
     int rows_{0}, cols_{0}, tile_{16};
-    std::vector<uint8_t> grid_; // row-major, 1 = wall, 0 = empty
-    static uint8_t decodeTile(char ch); // map file legend
+    std::pmr::vector<TileType> grid_; // row-major, see TileTypes.h for the legend
+    SDL_Texture* tileTex_[size_t(TileSprite::Count)]{};
     bool inBounds(int r, int c) const { return r>=0 && c>=0 && r<rows_ && c<cols_; }
-    uint8_t at(int r, int c) const { return grid_[r*cols_ + c]; }
-    uint8_t& at(int r, int c)      { return grid_[r*cols_ + c]; }
+    TileType at(int r, int c) const { return grid_[r*cols_ + c]; }
+    TileType& at(int r, int c)      { return grid_[r*cols_ + c]; }
+    void drawTile(SDL_Renderer* r, TileSprite sprite, const SDL_FRect& fr) const;
+    void queueTile(RenderQueue& q, TileSprite sprite, const SDL_FRect& fr, bool dim) const;
+
+    // distance field: samples at sub-tile centres with a one-sample solid border
+    std::pmr::vector<float> field_;
+    int fieldW_{0}, fieldH_{0};
+    float sampleSize() const { return float(tile_) / kFieldRes; }
+    float fieldAt(int sx, int sy) const;
+    void buildField();
+    // inclusive, padded sample coords; temporaries come from scratch
+    void updateField(int x0, int y0, int x1, int y1, std::pmr::memory_resource* scratch);
 };
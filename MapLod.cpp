@@ -0,0 +1,141 @@
+#include "MapLod.h"
+#include "Camera.h"
+#include "Log.h"
+#include "Map.h"
+#include "MemoryStats.h"
+#include "RenderQueue.h"
+#include "Visibility.h"
+#include <algorithm>
+#include <cmath>
+
+// unexplored tiles fade into the world clear colour used in main.cpp
+static constexpr SDL_Color kUnexplored{24, 28, 32, 255};
+static constexpr uint8_t   kUnseenAlpha = 153;   // same 40% brightness as Map's dimmed tiles
+
+static SDL_Texture* makeTexture(SDL_Renderer* r, SDL_TextureAccess access, int w, int h, SDL_ScaleMode scale) {
+    SDL_Texture* tex = SDL_CreateTexture(r, SDL_PIXELFORMAT_RGBA32, access, w, h);
+    if (!tex) return nullptr;
+    SDL_SetTextureBlendMode(tex, SDL_BLENDMODE_BLEND);
+    SDL_SetTextureScaleMode(tex, scale);
+    return tex;
+}
+
+void MapLod::release() {
+    for (SDL_Texture* t : levels_) {
+        brmem::untrackTexture(MemTag::Map, t);
+        SDL_DestroyTexture(t);
+    }
+    levels_.clear();
+    brmem::untrackTexture(MemTag::Map, fogTex_);
+    if (fogTex_) SDL_DestroyTexture(fogTex_);
+    fogTex_ = nullptr;
+}
+
+void MapLod::build(SDL_Renderer* r, const Map& map) {
+    release();
+    brmem::Scope scope(MemTag::Map);   // staging buffers
+    cols_ = map.cols();
+    rows_ = map.rows();
+    if (cols_ <= 0 || rows_ <= 0) return;
+
+    // level 0: one texel per tile
+    int w = cols_, h = rows_;
+    pixels_.resize(size_t(w) * h * 4);
+    for (int y = 0; y < h; ++y) {
+        for (int x = 0; x < w; ++x) {
+            const uint32_t c = tileMapColor(map.tileAt(y, x));
+            uint8_t* p = &pixels_[(size_t(y) * w + x) * 4];
+            p[0] = uint8_t(c >> 24); p[1] = uint8_t(c >> 16); p[2] = uint8_t(c >> 8); p[3] = uint8_t(c);
+        }
+    }
+
+    for (;;) {
+        SDL_Texture* tex = makeTexture(r, SDL_TEXTUREACCESS_STATIC, w, h,
+                                       levels_.empty() ? SDL_SCALEMODE_NEAREST : SDL_SCALEMODE_LINEAR);
+        if (!tex) {
+            BR_LOG_WARN("Map LOD level {} ({}x{}) failed: {}", int(levels_.size()), w, h, std::string_view(SDL_GetError()));
+            break;
+        }
+        SDL_UpdateTexture(tex, nullptr, pixels_.data(), w * 4);
+        levels_.push_back(tex);
+        brmem::trackTexture(MemTag::Map, tex);
+        if (w == 1 && h == 1) break;
+
+        // next level: 2x2 box filter, colour weighted by alpha so empty
+        // tiles thin walls out instead of darkening them; texels past the
+        // edge count as empty
+        const int nw = (w + 1) / 2, nh = (h + 1) / 2;
+        next_.assign(size_t(nw) * nh * 4, 0);
+        for (int y = 0; y < nh; ++y) {
+            for (int x = 0; x < nw; ++x) {
+                unsigned sum[4] = {0, 0, 0, 0};
+                for (int k = 0; k < 4; ++k) {
+                    const int sx = x * 2 + (k & 1), sy = y * 2 + (k >> 1);
+                    if (sx >= w || sy >= h) continue;
+                    const uint8_t* p = &pixels_[(size_t(sy) * w + sx) * 4];
+                    for (int ch = 0; ch < 3; ++ch) sum[ch] += unsigned(p[ch]) * p[3];
+                    sum[3] += p[3];
+                }
+                uint8_t* o = &next_[(size_t(y) * nw + x) * 4];
+                if (sum[3] > 0)
+                    for (int ch = 0; ch < 3; ++ch) o[ch] = uint8_t(sum[ch] / sum[3]);
+                o[3] = uint8_t(sum[3] / 4);
+            }
+        }
+        pixels_.swap(next_);
+        w = nw;
+        h = nh;
+    }
+
+    fogTex_ = makeTexture(r, SDL_TEXTUREACCESS_STREAMING, cols_, rows_, SDL_SCALEMODE_LINEAR);
+    brmem::trackTexture(MemTag::Map, fogTex_);
+    fogVersion_ = 0;
+    BR_LOG_DEBUG("Map LOD: {} levels from {}x{} tiles", int(levels_.size()), cols_, rows_);
+}
+
+bool MapLod::active(const Map& map, float pixelsPerUnit) const {
+    return !levels_.empty() && float(map.tileSize()) * pixelsPerUnit < kMinTilePixels;
+}
+
+// smallest level whose texels still cover at least one screen pixel
+int MapLod::levelFor(const Map& map, float pixelsPerUnit) const {
+    const float texel = float(map.tileSize()) * pixelsPerUnit;   // level 0 texel, in pixels
+    int level = texel >= 1.f ? 0 : int(std::ceil(std::log2(1.f / texel)));
+    return std::clamp(level, 0, int(levels_.size()) - 1);
+}
+
+void MapLod::updateFog(const Visibility& vis) {
+    if (!fogTex_ || vis.version() == fogVersion_) return;
+    fogVersion_ = vis.version();
+
+    pixels_.resize(size_t(cols_) * rows_ * 4);
+    for (int y = 0; y < rows_; ++y) {
+        for (int x = 0; x < cols_; ++x) {
+            uint8_t* p = &pixels_[(size_t(y) * cols_ + x) * 4];
+            if (!vis.explored(y, x)) {
+                p[0] = kUnexplored.r; p[1] = kUnexplored.g; p[2] = kUnexplored.b; p[3] = 255;
+            } else {
+                p[0] = p[1] = p[2] = 0;
+                p[3] = vis.visible(y, x) ? 0 : kUnseenAlpha;
+            }
+        }
+    }
+    SDL_UpdateTexture(fogTex_, nullptr, pixels_.data(), cols_ * 4);
+}
+
+void MapLod::render(RenderQueue& q, const Camera& cam, const Map& map, float pixelsPerUnit, const Visibility* vis) {
+    const int level = levelFor(map, pixelsPerUnit);
+    float tw = 0.f, th = 0.f;
+    SDL_GetTextureSize(levels_[level], &tw, &th);
+
+    // level textures may overhang the map by up to one texel of empty padding
+    const float texelWorld = float(map.tileSize()) * float(1 << level);
+    q.sprite(RenderLayer::Map, levels_[level],
+             SDL_FRect{ -cam.view.x, -cam.view.y, tw * texelWorld, th * texelWorld }, 0.f);
+
+    if (vis && fogTex_) {
+        updateFog(*vis);
+        q.sprite(RenderLayer::MapFog, fogTex_,
+                 SDL_FRect{ -cam.view.x, -cam.view.y, float(map.worldPixelWidth()), float(map.worldPixelHeight()) }, 0.f);
+    }
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <SDL3/SDL.h>
+#include <cstdint>
+#include <vector>
+class Camera;
+class Map;
+class RenderQueue;
+class Visibility;
+
+// Zoomed-out map rendering. At level load the tile grid is baked into a
+// chain of textures: level 0 has one texel per tile, level 1 one per 2x2
+// tiles, and so on down to 1x1 (box-filtered, alpha-weighted). Once tiles
+// get smaller than kMinTilePixels on screen, the map is drawn as a single
+// textured quad from the level whose texels are closest to one screen
+// pixel, so overview cost no longer depends on how many tiles are visible.
+// Fog of war is a second per-tile texture, refreshed only when the
+// visibility bits change.
+class MapLod {
+public:
+    static constexpr float kMinTilePixels = 12.f;
+
+    MapLod() = default;
+    ~MapLod() { release(); }
+    MapLod(const MapLod&) = delete;
+    MapLod& operator=(const MapLod&) = delete;
+
+    void build(SDL_Renderer* r, const Map& map);
+    void release();
+
+    // pixelsPerUnit: screen pixels per world pixel (zoom x render scale)
+    bool active(const Map& map, float pixelsPerUnit) const;
+    int  levelFor(const Map& map, float pixelsPerUnit) const;
+    void render(RenderQueue& q, const Camera& cam, const Map& map, float pixelsPerUnit, const Visibility* vis);
+
+    int levelCount() const { return int(levels_.size()); }
+
+private:
+    void updateFog(const Visibility& vis);
+
+    std::vector<SDL_Texture*>  levels_;
+    SDL_Texture*               fogTex_{nullptr};
+    uint32_t                   fogVersion_{0};
+    int                        cols_{0}, rows_{0};
+    std::vector<uint8_t>       pixels_, next_;   // RGBA32 staging, reused between levels
+};
@@ -0,0 +1,181 @@
+#include "MemoryStats.h"
+#include "Log.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <string_view>
+
+namespace brmem {
+namespace {
+
+struct Counter {
+    std::atomic<size_t> bytes{0}, peak{0}, allocs{0};
+
+    void add(size_t n) {
+        const size_t now = bytes.fetch_add(n, std::memory_order_relaxed) + n;
+        allocs.fetch_add(1, std::memory_order_relaxed);
+        size_t p = peak.load(std::memory_order_relaxed);
+        while (now > p && !peak.compare_exchange_weak(p, now, std::memory_order_relaxed)) {}
+    }
+    void sub(size_t n) { bytes.fetch_sub(n, std::memory_order_relaxed); }
+    Usage load() const {
+        return { bytes.load(std::memory_order_relaxed), peak.load(std::memory_order_relaxed),
+                 allocs.load(std::memory_order_relaxed) };
+    }
+};
+
+constexpr int kPools = int(Pool::Count);
+constexpr int kTags  = int(MemTag::Count);
+
+// constant-initialised, so the hooks may run before main()
+Counter g_byTag[kPools][kTags];
+Counter g_total[kPools];
+
+thread_local MemTag   t_tag    = MemTag::Other;
+thread_local uint64_t t_allocs = 0;
+
+} // namespace
+
+const char* tagName(MemTag t) {
+    switch (t) {
+        case MemTag::Other:    return "other";
+        case MemTag::Loader:   return "loader";
+        case MemTag::Map:      return "map";
+        case MemTag::Nav:      return "nav";
+        case MemTag::Fog:      return "fog";
+        case MemTag::Pvs:      return "pvs";
+        case MemTag::Entities: return "entities";
+        case MemTag::Render:   return "render";
+        case MemTag::Assets:   return "assets";
+        case MemTag::Ghosts:   return "ghosts";
+        case MemTag::Count:    break;
+    }
+    return "?";
+}
+
+bool hooksEnabled() { return BR_MEMORY_HOOKS != 0; }
+
+void recordAlloc(Pool p, MemTag t, size_t bytes) {
+    g_byTag[int(p)][int(t)].add(bytes);
+    g_total[int(p)].add(bytes);
+}
+
+void recordFree(Pool p, MemTag t, size_t bytes) {
+    g_byTag[int(p)][int(t)].sub(bytes);
+    g_total[int(p)].sub(bytes);
+}
+
+Usage usage(Pool p, MemTag t) { return g_byTag[int(p)][int(t)].load(); }
+Usage total(Pool p)           { return g_total[int(p)].load(); }
+
+Scope::Scope(MemTag t) : prev_(t_tag) { t_tag = t; }
+Scope::~Scope() { t_tag = prev_; }
+MemTag currentTag() { return t_tag; }
+uint64_t threadAllocations() { return t_allocs; }
+
+size_t textureBytes(SDL_Texture* tex) {
+    if (!tex) return 0;
+    return size_t(tex->w) * size_t(tex->h) * size_t(SDL_BYTESPERPIXEL(tex->format));
+}
+
+void trackTexture(MemTag t, SDL_Texture* tex) {
+    if (tex) recordAlloc(Pool::Texture, t, textureBytes(tex));
+}
+
+void untrackTexture(MemTag t, SDL_Texture* tex) {
+    if (tex) recordFree(Pool::Texture, t, textureBytes(tex));
+}
+
+void AllocWatch::check() {
+    const uint64_t now = threadAllocations();
+    const uint64_t n = now - last_;
+    last_ = now;
+    if (n == 0) return;
+    // the first few are enough to find the culprit; the rest only count
+    if (++hits_ <= 3) BR_LOG_WARN("{}: {} heap allocations in steady state", where_, n);
+}
+
+void report(const char* why) {
+    BR_LOG_INFO("Memory report ({}){}", std::string_view(why),
+                hooksEnabled() ? "" : ", heap hooks off (BR_MEMORY_HOOKS=0)");
+    for (int i = 0; i < kTags; ++i) {
+        const MemTag t = MemTag(i);
+        const Usage h = usage(Pool::Heap, t), a = usage(Pool::Arena, t), x = usage(Pool::Texture, t);
+        if (h.allocs == 0 && a.allocs == 0 && x.allocs == 0) continue;
+        if (h.allocs > 0)
+            BR_LOG_INFO("  {}: heap {} KiB now, {} KiB peak, {} allocs", tagName(t), h.bytes / 1024, h.peak / 1024, h.allocs);
+        if (a.allocs > 0)
+            BR_LOG_INFO("  {}: level arena {} KiB now, {} KiB peak, {} allocs", tagName(t), a.bytes / 1024, a.peak / 1024, a.allocs);
+        if (x.allocs > 0)
+            BR_LOG_INFO("  {}: textures ~{} KiB now, {} KiB peak", tagName(t), x.bytes / 1024, x.peak / 1024);
+    }
+    const Usage h = total(Pool::Heap), a = total(Pool::Arena), x = total(Pool::Texture);
+    BR_LOG_INFO("  total heap {} KiB now, {} KiB peak, {} allocs", h.bytes / 1024, h.peak / 1024, h.allocs);
+    BR_LOG_INFO("  total level arena {} KiB now, {} KiB peak", a.bytes / 1024, a.peak / 1024);
+    BR_LOG_INFO("  total textures ~{} KiB now, {} KiB peak", x.bytes / 1024, x.peak / 1024);
+}
+
+} // namespace brmem
+
+#if BR_MEMORY_HOOKS
+// Global allocation hooks. Each block carries a small header just below the
+// pointer with the size and tag it was charged to, so frees credit the right
+// subsystem even when another thread or scope releases it.
+namespace {
+
+struct Header {
+    void*  raw;
+    size_t size;
+    MemTag tag;
+};
+
+void* hookedAlloc(size_t size, size_t align) noexcept {
+    if (align < alignof(std::max_align_t)) align = alignof(std::max_align_t);
+    void* raw = std::malloc(size + sizeof(Header) + align);
+    if (!raw) return nullptr;
+    const uintptr_t p = (uintptr_t(raw) + sizeof(Header) + align - 1) & ~uintptr_t(align - 1);
+    Header* h = reinterpret_cast<Header*>(p) - 1;
+    h->raw  = raw;
+    h->size = size;
+    h->tag  = brmem::t_tag;
+    ++brmem::t_allocs;
+    brmem::recordAlloc(brmem::Pool::Heap, h->tag, size);
+    return reinterpret_cast<void*>(p);
+}
+
+void hookedFree(void* p) noexcept {
+    if (!p) return;
+    const Header* h = static_cast<Header*>(p) - 1;
+    brmem::recordFree(brmem::Pool::Heap, h->tag, h->size);
+    std::free(h->raw);
+}
+
+void* allocOrThrow(size_t size, size_t align) {
+    if (void* p = hookedAlloc(size ? size : 1, align)) return p;
+    throw std::bad_alloc();
+}
+
+} // namespace
+
+void* operator new(size_t n)                                          { return allocOrThrow(n, 0); }
+void* operator new[](size_t n)                                        { return allocOrThrow(n, 0); }
+void* operator new(size_t n, std::align_val_t a)                      { return allocOrThrow(n, size_t(a)); }
+void* operator new[](size_t n, std::align_val_t a)                    { return allocOrThrow(n, size_t(a)); }
+void* operator new(size_t n, const std::nothrow_t&) noexcept          { return hookedAlloc(n ? n : 1, 0); }
+void* operator new[](size_t n, const std::nothrow_t&) noexcept        { return hookedAlloc(n ? n : 1, 0); }
+void* operator new(size_t n, std::align_val_t a, const std::nothrow_t&) noexcept   { return hookedAlloc(n ? n : 1, size_t(a)); }
+void* operator new[](size_t n, std::align_val_t a, const std::nothrow_t&) noexcept { return hookedAlloc(n ? n : 1, size_t(a)); }
+
+void operator delete(void* p) noexcept                                { hookedFree(p); }
+void operator delete[](void* p) noexcept                              { hookedFree(p); }
+void operator delete(void* p, size_t) noexcept                        { hookedFree(p); }
+void operator delete[](void* p, size_t) noexcept                      { hookedFree(p); }
+void operator delete(void* p, std::align_val_t) noexcept              { hookedFree(p); }
+void operator delete[](void* p, std::align_val_t) noexcept            { hookedFree(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept      { hookedFree(p); }
+void operator delete[](void* p, size_t, std::align_val_t) noexcept    { hookedFree(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept         { hookedFree(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept       { hookedFree(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept   { hookedFree(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { hookedFree(p); }
+#endif
@@ -0,0 +1,99 @@
+#pragma once
+#include <SDL3/SDL.h>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+
+// Memory accounting by subsystem.
+//
+// Three pools are tracked per tag:
+//  - Heap: every global operator new/delete, charged to the calling thread's
+//    current Scope tag (untagged code lands in Other). Needs BR_MEMORY_HOOKS.
+//  - Arena: level data, through TaggedResource on top of the level arena.
+//  - Texture: estimated GPU bytes (w * h * bytes per pixel) of tracked textures.
+// Each keeps current and peak bytes and an allocation count. report() logs
+// the table; AllocWatch flags code that allocates once it should not.
+
+#ifndef BR_MEMORY_HOOKS
+#define BR_MEMORY_HOOKS 0
+#endif
+
+enum class MemTag : uint8_t { Other, Loader, Map, Nav, Fog, Pvs, Entities, Render, Assets, Ghosts, Count };
+
+namespace brmem {
+
+enum class Pool : uint8_t { Heap, Arena, Texture, Count };
+
+struct Usage {
+    size_t bytes  = 0;   // live now
+    size_t peak   = 0;
+    size_t allocs = 0;   // allocations ever made
+};
+
+const char* tagName(MemTag t);
+bool hooksEnabled();
+
+void recordAlloc(Pool p, MemTag t, size_t bytes);
+void recordFree(Pool p, MemTag t, size_t bytes);
+Usage usage(Pool p, MemTag t);
+Usage total(Pool p);
+
+// Heap allocations charged to this thread's tag until the scope ends.
+class Scope {
+public:
+    explicit Scope(MemTag t);
+    ~Scope();
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+private:
+    MemTag prev_;
+};
+MemTag currentTag();
+uint64_t threadAllocations();   // heap allocations made by the calling thread so far
+
+// Estimated size of a texture; track right after creating, untrack right
+// before destroying.
+size_t textureBytes(SDL_Texture* tex);
+void trackTexture(MemTag t, SDL_Texture* tex);
+void untrackTexture(MemTag t, SDL_Texture* tex);
+
+// Warns when the calling thread allocated since the last check(), e.g. once
+// per frame. Call rearm() after work that is allowed to allocate (level load).
+class AllocWatch {
+public:
+    explicit AllocWatch(const char* where) : where_(where) {}
+    void check();
+    void rearm() { last_ = threadAllocations(); }
+    uint64_t hits() const { return hits_; }   // checks that saw allocations
+private:
+    const char* where_;
+    uint64_t    last_{threadAllocations()};
+    uint64_t    hits_{0};
+};
+
+// Footprint table, current and peak per tag and pool.
+void report(const char* why);
+
+} // namespace brmem
+
+// Forwards to another resource and charges what passes through to one tag
+// of the Arena pool.
+class TaggedResource : public std::pmr::memory_resource {
+public:
+    TaggedResource(MemTag tag, std::pmr::memory_resource* upstream) : tag_(tag), upstream_(upstream) {}
+
+private:
+    void* do_allocate(size_t bytes, size_t align) override {
+        void* p = upstream_->allocate(bytes, align);
+        brmem::recordAlloc(brmem::Pool::Arena, tag_, bytes);
+        return p;
+    }
+    void do_deallocate(void* p, size_t bytes, size_t align) override {
+        brmem::recordFree(brmem::Pool::Arena, tag_, bytes);
+        upstream_->deallocate(p, bytes, align);
+    }
+    bool do_is_equal(const std::pmr::memory_resource& o) const noexcept override { return this == &o; }
+
+    MemTag                     tag_;
+    std::pmr::memory_resource* upstream_;
+};
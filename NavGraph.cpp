@@ -0,0 +1,389 @@
+#include "NavGraph.h"
+#include "Map.h"
+#include "WorldState.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+static constexpr float kInf = std::numeric_limits<float>::infinity();
+static constexpr int   K    = NavGraph::kClusterSize;
+
+NavGraph::NavGraph(std::pmr::memory_resource* mem)
+: mem_(mem), solid_(mem), region_(mem), regions_(mem), regionNodes_(mem), nodes_(mem), edges_(mem),
+  gCost_(mem), parent_(mem), stamp_(mem), open_(mem), startDist_(mem), goalDist_(mem), pathDist_(mem),
+  bfsQueue_(mem), bfsParent_(mem), chain_(mem), tiles_(mem), segment_(mem) {}
+
+int NavGraph::tileAt(float px, float py) const {
+    const int c = int(std::floor(px / tile_));
+    const int r = int(std::floor(py / tile_));
+    if (r < 0 || c < 0 || r >= rows_ || c >= cols_) return -1;
+    return r * cols_ + c;
+}
+
+SDL_FPoint NavGraph::tileCenter(int tile) const {
+    return { (tile % cols_) * tile_ + tile_ * 0.5f, (tile / cols_) * tile_ + tile_ * 0.5f };
+}
+
+static inline int localIndex(int tile, int cols) {
+    return ((tile / cols) % K) * K + (tile % cols) % K;
+}
+
+void NavGraph::build(const Map& map) {
+    rows_ = map.rows();
+    cols_ = map.cols();
+    tile_ = map.tileSize();
+    sectorsX_ = (cols_ + K - 1) / K;
+    sectorsY_ = (rows_ + K - 1) / K;
+
+    const int n = rows_ * cols_;
+    solid_.assign(n, 0);
+    for (int t = 0; t < n; ++t) {
+        const SDL_FPoint c = tileCenter(t);
+        solid_[t] = map.isWallAtPixel(c.x, c.y) ? 1 : 0;
+    }
+
+    // regions: connected open areas inside each sector
+    region_.assign(n, -1);
+    regions_.clear();
+    std::pmr::vector<int> queue(mem_);
+    queue.reserve(K * K);
+    for (int t = 0; t < n; ++t) {
+        if (solid_[t] || region_[t] >= 0) continue;
+        const int r0 = t / cols_, c0 = t % cols_;
+        const int sr = r0 / K, sc = c0 / K;
+        const int id = int(regions_.size());
+
+        queue.clear();
+        queue.push_back(t);
+        region_[t] = id;
+        float sumR = 0.f, sumC = 0.f;
+        for (size_t qi = 0; qi < queue.size(); ++qi) {
+            const int cur = queue[qi];
+            const int r = cur / cols_, c = cur % cols_;
+            sumR += float(r); sumC += float(c);
+            const int nr[4] = { r - 1, r + 1, r, r };
+            const int nc[4] = { c, c, c - 1, c + 1 };
+            for (int k = 0; k < 4; ++k) {
+                if (nr[k] < 0 || nc[k] < 0 || nr[k] >= rows_ || nc[k] >= cols_) continue;
+                if (nr[k] / K != sr || nc[k] / K != sc) continue;
+                const int nt = nr[k] * cols_ + nc[k];
+                if (solid_[nt] || region_[nt] >= 0) continue;
+                region_[nt] = id;
+                queue.push_back(nt);
+            }
+        }
+        // representative tile: the region tile closest to its centroid
+        const float mr = sumR / float(queue.size()), mc = sumC / float(queue.size());
+        int best = t;
+        float bestD = kInf;
+        for (int q : queue) {
+            const float dr = float(q / cols_) - mr, dc = float(q % cols_) - mc;
+            if (dr*dr + dc*dc < bestD) { bestD = dr*dr + dc*dc; best = q; }
+        }
+        regions_.push_back({ sr * sectorsX_ + sc, -1, best, 0, 0 });
+    }
+
+    // global connectivity, so unreachable targets are rejected without a search
+    std::pmr::vector<int> comp(n, -1, mem_);
+    int comps = 0;
+    for (int t = 0; t < n; ++t) {
+        if (solid_[t] || comp[t] >= 0) continue;
+        queue.clear();
+        queue.push_back(t);
+        comp[t] = comps;
+        for (size_t qi = 0; qi < queue.size(); ++qi) {
+            const int cur = queue[qi];
+            const int r = cur / cols_, c = cur % cols_;
+            const int nr[4] = { r - 1, r + 1, r, r };
+            const int nc[4] = { c, c, c - 1, c + 1 };
+            for (int k = 0; k < 4; ++k) {
+                if (nr[k] < 0 || nc[k] < 0 || nr[k] >= rows_ || nc[k] >= cols_) continue;
+                const int nt = nr[k] * cols_ + nc[k];
+                if (solid_[nt] || comp[nt] >= 0) continue;
+                comp[nt] = comps;
+                queue.push_back(nt);
+            }
+        }
+        ++comps;
+    }
+    for (int t = 0; t < n; ++t)
+        if (region_[t] >= 0) regions_[region_[t]].component = comp[t];
+
+    // portals: middle of every run along a sector border where the same two
+    // regions face each other
+    nodes_.clear();
+    std::pmr::vector<int> nodeAt(n, -1, mem_);
+    std::pmr::vector<std::pmr::vector<Edge>> adj(mem_);
+    auto nodeFor = [&](int tile) {
+        if (nodeAt[tile] < 0) {
+            nodeAt[tile] = int(nodes_.size());
+            nodes_.push_back({ tile, region_[tile], 0, 0 });
+            adj.emplace_back();
+        }
+        return nodeAt[tile];
+    };
+    auto link = [&](int a, int b) {
+        const int na = nodeFor(a), nb = nodeFor(b);
+        adj[na].push_back({ nb, 1.f });
+        adj[nb].push_back({ na, 1.f });
+    };
+    auto scanBorder = [&](int count, auto sideA, auto sideB) {
+        int runStart = -1;
+        for (int i = 0; i <= count; ++i) {
+            bool open = false;
+            if (i < count) {
+                const int a = sideA(i), b = sideB(i);
+                open = !solid_[a] && !solid_[b];
+                if (open && runStart >= 0 &&
+                    (region_[a] != region_[sideA(runStart)] || region_[b] != region_[sideB(runStart)]))
+                {
+                    const int mid = (runStart + i - 1) / 2;
+                    link(sideA(mid), sideB(mid));
+                    runStart = i;
+                    continue;
+                }
+            }
+            if (open && runStart < 0) runStart = i;
+            if (!open && runStart >= 0) {
+                const int mid = (runStart + i - 1) / 2;
+                link(sideA(mid), sideB(mid));
+                runStart = -1;
+            }
+        }
+    };
+    for (int sy = 0; sy < sectorsY_; ++sy) {
+        const int r0 = sy * K, r1 = std::min(rows_, r0 + K);
+        for (int sx = 0; sx + 1 < sectorsX_; ++sx) {
+            const int c = (sx + 1) * K - 1;
+            scanBorder(r1 - r0, [&](int i) { return (r0 + i) * cols_ + c; },
+                                [&](int i) { return (r0 + i) * cols_ + c + 1; });
+        }
+    }
+    for (int sy = 0; sy + 1 < sectorsY_; ++sy) {
+        const int r = (sy + 1) * K - 1;
+        for (int sx = 0; sx < sectorsX_; ++sx) {
+            const int c0 = sx * K, c1 = std::min(cols_, c0 + K);
+            scanBorder(c1 - c0, [&](int i) { return r * cols_ + c0 + i; },
+                                [&](int i) { return (r + 1) * cols_ + c0 + i; });
+        }
+    }
+
+    // group portals by region, then link portals sharing a region with their
+    // in-sector path length
+    std::pmr::vector<std::pmr::vector<int>> byRegion(regions_.size(), mem_);
+    for (int i = 0; i < int(nodes_.size()); ++i) byRegion[nodes_[i].region].push_back(i);
+    regionNodes_.clear();
+    for (int r = 0; r < int(regions_.size()); ++r) {
+        regions_[r].firstNode = int(regionNodes_.size());
+        regions_[r].nodeCount = int(byRegion[r].size());
+        regionNodes_.insert(regionNodes_.end(), byRegion[r].begin(), byRegion[r].end());
+    }
+
+    std::pmr::vector<float> dist(mem_);
+    for (int i = 0; i < int(nodes_.size()); ++i) {
+        const Region& reg = regions_[nodes_[i].region];
+        if (reg.nodeCount < 2) continue;
+        regionBfs(nodes_[i].tile, dist);
+        for (int k = 0; k < reg.nodeCount; ++k) {
+            const int j = regionNodes_[reg.firstNode + k];
+            if (j != i) adj[i].push_back({ j, dist[localIndex(nodes_[j].tile, cols_)] });
+        }
+    }
+
+    edges_.clear();
+    for (int i = 0; i < int(nodes_.size()); ++i) {
+        nodes_[i].firstEdge = int(edges_.size());
+        nodes_[i].edgeCount = int(adj[i].size());
+        edges_.insert(edges_.end(), adj[i].begin(), adj[i].end());
+    }
+
+    gCost_.assign(nodes_.size() + 1, kInf);
+    parent_.assign(nodes_.size() + 1, -1);
+    stamp_.assign(nodes_.size() + 1, 0);
+    curStamp_ = 0;
+    open_.reserve(edges_.size() + nodes_.size() + 1);   // one push per relaxation at most
+    startDist_.reserve(K * K);
+    pathDist_.reserve(K * K);
+    goalDist_.reserve(K * K);
+    bfsQueue_.reserve(K * K);
+    bfsParent_.reserve(K * K);
+    tiles_.reserve(n);
+    segment_.reserve(K * K);
+    chain_.reserve(nodes_.size());
+}
+
+void NavGraph::regionBfs(int fromTile, std::pmr::vector<float>& dist) const {
+    dist.assign(K * K, kInf);
+    bfsParent_.assign(K * K, -1);
+    bfsQueue_.clear();
+
+    const int reg = region_[fromTile];
+    dist[localIndex(fromTile, cols_)] = 0.f;
+    bfsQueue_.push_back(fromTile);
+    for (size_t qi = 0; qi < bfsQueue_.size(); ++qi) {
+        const int cur = bfsQueue_[qi];
+        const int r = cur / cols_, c = cur % cols_;
+        const float d = dist[localIndex(cur, cols_)] + 1.f;
+        const int nr[4] = { r - 1, r + 1, r, r };
+        const int nc[4] = { c, c, c - 1, c + 1 };
+        for (int k = 0; k < 4; ++k) {
+            if (nr[k] < 0 || nc[k] < 0 || nr[k] >= rows_ || nc[k] >= cols_) continue;
+            const int nt = nr[k] * cols_ + nc[k];
+            if (region_[nt] != reg) continue;
+            const int li = localIndex(nt, cols_);
+            if (dist[li] != kInf) continue;
+            dist[li] = d;
+            bfsParent_[li] = cur;
+            bfsQueue_.push_back(nt);
+        }
+    }
+}
+
+bool NavGraph::regionPath(int from, int to, std::pmr::vector<int>& outTiles) const {
+    outTiles.clear();
+    if (region_[from] != region_[to]) return false;
+    regionBfs(from, pathDist_);
+    for (int t = to; t != -1; t = bfsParent_[localIndex(t, cols_)]) {
+        outTiles.push_back(t);
+        if (t == from) break;
+    }
+    std::reverse(outTiles.begin(), outTiles.end());
+    return !outTiles.empty() && outTiles.front() == from;
+}
+
+// Straight segment between tile centres that keeps a car-width margin off walls.
+bool NavGraph::clearLine(int a, int b) const {
+    const SDL_FPoint pa = tileCenter(a), pb = tileCenter(b);
+    const float dx = pb.x - pa.x, dy = pb.y - pa.y;
+    const float len = std::sqrt(dx*dx + dy*dy);
+    if (len < 1.f) return true;
+    const float nx = -dy / len, ny = dx / len;
+    const float margin = tile_ * 0.35f;
+    const int steps = int(len / (tile_ * 0.25f)) + 1;
+    for (int i = 0; i <= steps; ++i) {
+        const float t = float(i) / float(steps);
+        const float px = pa.x + dx * t, py = pa.y + dy * t;
+        for (float off : { 0.f, margin, -margin }) {
+            const int tt = tileAt(px + nx * off, py + ny * off);
+            if (tt < 0 || solid_[tt]) return false;
+        }
+    }
+    return true;
+}
+
+// Greedy string pulling; the look-ahead is capped so cost stays linear in
+// path length rather than quadratic on long open stretches.
+int NavGraph::smooth(const std::pmr::vector<int>& tiles, SDL_FPoint* out, int maxPoints) const {
+    constexpr size_t kMaxSkip = 12;
+    int written = 0;
+    size_t anchor = 0;
+    while (anchor + 1 < tiles.size() && written < maxPoints) {
+        size_t next = anchor + 1;
+        while (next + 1 < tiles.size() && next + 1 - anchor <= kMaxSkip &&
+               clearLine(tiles[anchor], tiles[next + 1])) ++next;
+        out[written++] = tileCenter(tiles[next]);
+        anchor = next;
+    }
+    return written;
+}
+
+int NavGraph::findRoute(float sx, float sy, float gx, float gy, SDL_FPoint* out, int maxPoints) const {
+    const int s = tileAt(sx, sy), g = tileAt(gx, gy);
+    if (!walkable(s) || !walkable(g) || maxPoints <= 0) return 0;
+
+    const int rs = region_[s], rg = region_[g];
+    if (regions_[rs].component != regions_[rg].component) return 0;
+
+    tiles_.clear();
+    if (rs == rg) {
+        if (!regionPath(s, g, tiles_)) return 0;
+        return smooth(tiles_, out, maxPoints);
+    }
+
+    // abstract A* over portals; index nodes_.size() is the virtual goal
+    const int goalNode = int(nodes_.size());
+    const int gr = g / cols_, gc = g % cols_;
+    auto h = [&](int tile) { return float(std::abs(tile / cols_ - gr) + std::abs(tile % cols_ - gc)); };
+    auto cmp = [](const std::pair<float, int>& a, const std::pair<float, int>& b) { return a.first > b.first; };
+    if (++curStamp_ == 0) { std::fill(stamp_.begin(), stamp_.end(), 0u); curStamp_ = 1; }
+    auto cost = [&](int i) { return stamp_[i] == curStamp_ ? gCost_[i] : kInf; };
+    auto relax = [&](int i, float gc2, int from) {
+        if (gc2 >= cost(i)) return;
+        stamp_[i] = curStamp_;
+        gCost_[i] = gc2;
+        parent_[i] = from;
+        open_.push_back({ gc2 + (i == goalNode ? 0.f : h(nodes_[i].tile)), i });
+        std::push_heap(open_.begin(), open_.end(), cmp);
+    };
+
+    regionBfs(g, goalDist_);
+    regionBfs(s, startDist_);
+    open_.clear();
+    const Region& startReg = regions_[rs];
+    for (int k = 0; k < startReg.nodeCount; ++k) {
+        const int ni = regionNodes_[startReg.firstNode + k];
+        relax(ni, startDist_[localIndex(nodes_[ni].tile, cols_)], -1);
+    }
+
+    bool found = false;
+    while (!open_.empty()) {
+        std::pop_heap(open_.begin(), open_.end(), cmp);
+        const auto [f, cur] = open_.back();
+        open_.pop_back();
+        if (cur == goalNode) { found = true; break; }
+        const float gcur = cost(cur);
+        if (f > gcur + h(nodes_[cur].tile) + 1e-3f) continue; // stale entry
+
+        const Node& nd = nodes_[cur];
+        if (nd.region == rg) relax(goalNode, gcur + goalDist_[localIndex(nd.tile, cols_)], cur);
+        for (int e = 0; e < nd.edgeCount; ++e) {
+            const Edge& ed = edges_[nd.firstEdge + e];
+            relax(ed.to, gcur + ed.cost, cur);
+        }
+    }
+    if (!found) return 0;
+
+    chain_.clear();
+    for (int i = parent_[goalNode]; i != -1; i = parent_[i]) chain_.push_back(i);
+    std::reverse(chain_.begin(), chain_.end());
+
+    // refine: in-region hops become sector-local tile paths, portal hops are one step
+    tiles_.push_back(s);
+    int prev = s;
+    auto appendTo = [&](int target) {
+        if (region_[prev] == region_[target]) {
+            regionPath(prev, target, segment_);
+            tiles_.insert(tiles_.end(), segment_.begin() + 1, segment_.end());
+        } else {
+            tiles_.push_back(target);
+        }
+        prev = target;
+    };
+    for (int ni : chain_) appendTo(nodes_[ni].tile);
+    appendTo(g);
+
+    return smooth(tiles_, out, maxPoints);
+}
+
+bool NavGraph::randomPatrolTarget(Rng& rng, float x, float y, float& tx, float& ty) const {
+    const int s = tileAt(x, y);
+    if (!walkable(s) || regions_.size() < 2) return false;
+    const int here = region_[s];
+    const int comp = regions_[here].component;
+    for (int attempt = 0; attempt < 16; ++attempt) {
+        const int r = rng.range(int(regions_.size()));
+        if (r == here || regions_[r].component != comp) continue;
+
+        // a random tile of that region so repeated patrols don't retrace the
+        // same centre-to-centre lines; fall back to its centre
+        int target = regions_[r].centerTile;
+        const int sr = (regions_[r].sector / sectorsX_) * K, sc = (regions_[r].sector % sectorsX_) * K;
+        const int tr = sr + rng.range(K), tc = sc + rng.range(K);
+        if (tr < rows_ && tc < cols_ && region_[tr * cols_ + tc] == r) target = tr * cols_ + tc;
+
+        const SDL_FPoint c = tileCenter(target);
+        tx = c.x; ty = c.y;
+        return true;
+    }
+    return false;
+}
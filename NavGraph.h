@@ -0,0 +1,90 @@
+#pragma once
+#include <SDL3/SDL.h>
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+class Map;
+struct Rng;
+
+// Hierarchical navigation graph (HPA*-style) built once per level.
+//
+// The grid is cut into kClusterSize x kClusterSize sectors; each sector is
+// split into regions (its connected open areas), so a walled room and the
+// corridor around it become separate regions even inside one sector.
+// Wherever two regions in neighbouring sectors touch, the middle of the
+// shared run becomes a portal pair. Portals in the same region are linked
+// with their precomputed in-sector path length. Long routes are searched on
+// this small portal graph and only refined to tiles inside the sectors the
+// route passes through.
+//
+// Queries reuse internal scratch buffers: use from one thread (the sim).
+// All storage, including build temporaries, comes from the memory resource
+// given at construction (the level arena in the game).
+class NavGraph {
+public:
+    static constexpr int kClusterSize = 8;
+
+    explicit NavGraph(std::pmr::memory_resource* mem = std::pmr::get_default_resource());
+
+    void build(const Map& map);
+
+    // Plans from (sx,sy) to (gx,gy) in world pixels and writes up to
+    // maxPoints smoothed waypoints (tile centres). Returns the number written;
+    // 0 means unreachable (or already in the goal tile). Routes longer than
+    // maxPoints are cut short; the caller re-plans from the last waypoint.
+    int findRoute(float sx, float sy, float gx, float gy, SDL_FPoint* out, int maxPoints) const;
+
+    // Picks a tile in a random region reachable from (x,y), other than the
+    // one (x,y) is in.
+    bool randomPatrolTarget(Rng& rng, float x, float y, float& tx, float& ty) const;
+
+    int regionCount() const { return int(regions_.size()); }
+    int portalCount() const { return int(nodes_.size()); }
+
+private:
+    struct Region {
+        int sector;
+        int component;   // global connectivity label
+        int centerTile;
+        int firstNode, nodeCount;   // into regionNodes_
+    };
+    struct Node {
+        int tile;
+        int region;
+        int firstEdge, edgeCount;   // into edges_
+    };
+    struct Edge {
+        int   to;
+        float cost;
+    };
+
+    bool walkable(int tile) const { return tile >= 0 && region_[tile] >= 0; }
+    int  tileAt(float px, float py) const;
+    SDL_FPoint tileCenter(int tile) const;
+
+    // BFS restricted to one region; fills dist (and parents) for the sector's tiles
+    void regionBfs(int fromTile, std::pmr::vector<float>& dist) const;
+    bool regionPath(int from, int to, std::pmr::vector<int>& outTiles) const;
+
+    bool clearLine(int a, int b) const;
+    int  smooth(const std::pmr::vector<int>& tiles, SDL_FPoint* out, int maxPoints) const;
+
+    std::pmr::memory_resource* mem_;
+    int rows_{0}, cols_{0}, tile_{32};
+    int sectorsX_{0}, sectorsY_{0};
+    std::pmr::vector<uint8_t> solid_;        // per tile
+    std::pmr::vector<int>     region_;       // per tile, -1 = solid
+    std::pmr::vector<Region>  regions_;
+    std::pmr::vector<int>     regionNodes_;  // node ids grouped by region
+    std::pmr::vector<Node>    nodes_;
+    std::pmr::vector<Edge>    edges_;
+
+    // query scratch (stamped so nothing is cleared per query), sized in build()
+    mutable std::pmr::vector<float>    gCost_;
+    mutable std::pmr::vector<int>      parent_;
+    mutable std::pmr::vector<uint32_t> stamp_;
+    mutable uint32_t                   curStamp_{0};
+    mutable std::pmr::vector<std::pair<float, int>> open_;
+    mutable std::pmr::vector<float>    startDist_, goalDist_, pathDist_;
+    mutable std::pmr::vector<int>      bfsQueue_, bfsParent_, chain_, tiles_, segment_;
+};
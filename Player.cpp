@@ -1,5 +1,6 @@
 #include "Player.h"
 #include "Camera.h"
+#include "RenderQueue.h"
 #include <algorithm>
 #include <cmath>
 
@@ -19,7 +20,7 @@ void Player::setInputs(float throttle, float brake, float steer) {
     steerIn_  = clampf(steer,    -1.f,  1.f);
 }
 
-void Player::update(float dt, Map &map, int tileSize)
+void Player::update(float dt, const Map &map, int tileSize)
 {
     // steering
     if (steerIn_ != 0.f) {
@@ -36,9 +37,10 @@ void Player::update(float dt, Map &map, int tileSize)
     else if (throttle_ < 0.f)  a += throttle_ * reverseAcc_;
     if (brake_ > 0.f)          a += brake_ * brakeAcc_ * (v_ != 0.f ? -sgnf(v_) : -1.f);
 
-    // losses
-    a += -sgnf(v_) * rolling_;
-    a += -drag_ * v_ * std::abs(v_);
+    // losses (terrain scales rolling resistance and drag, e.g. dirt)
+    const float friction = map.frictionAtPixel(x_, y_);
+    a += -sgnf(v_) * rolling_ * friction;
+    a += -drag_ * friction * v_ * std::abs(v_);
 
     // integrate speed
     v_ += a * dt;
@@ -66,7 +68,11 @@ void Player::update(float dt, Map &map, int tileSize)
     const float eps = 0.01f;
 
     // circle hit test (cardinals)
+    // the distance field rules out most positions with one lookup; only
+    // near walls fall through to the tile probes that drive the edge snapping
+    const float clearRadius = radius + map.clearanceSlack();
     auto circleHitsWall = [&](float px, float py) -> bool {
+        if (map.clearanceAt(px, py) > clearRadius) return false;
         if (map.isWallAtPixel(px, py)) return true;
         return map.isWallAtPixel(px + radius, py) ||
                map.isWallAtPixel(px - radius, py) ||
@@ -101,7 +107,7 @@ void Player::update(float dt, Map &map, int tileSize)
     }
 }
 
-void Player::render(SDL_Renderer* ren, SDL_Texture* tex) {
+void Player::render(SDL_Renderer* ren, SDL_Texture* tex) const {
     // texture size cache
     if (tex && !haveSize_) {
         float w = 0.f, h = 0.f;
@@ -124,7 +130,11 @@ void Player::render(SDL_Renderer* ren, SDL_Texture* tex) {
     }
 }
 
-void Player::render(SDL_Renderer* ren, SDL_Texture* tex, const Camera& cam) {
+void Player::render(RenderQueue& q, SDL_Texture* tex, const Camera& cam) const {
+    render(q, tex, cam, RenderLayer::Players, tex ? SDL_Color{255, 255, 255, 255} : SDL_Color{30, 140, 230, 255});
+}
+
+void Player::render(RenderQueue& q, SDL_Texture* tex, const Camera& cam, RenderLayer layer, SDL_Color tint) const {
     // Texture size cache
     if (tex && !haveSize_) {
         float w = 0.f, h = 0.f;
@@ -143,12 +153,7 @@ void Player::render(SDL_Renderer* ren, SDL_Texture* tex, const Camera& cam) {
         texW_ * scale,
         texH_ * scale
     };
-    SDL_FPoint center { dst.w * 0.5f, dst.h * 0.5f };
 
-    if (tex) {
-        SDL_RenderTextureRotated(ren, tex, nullptr, &dst, double(heading_), &center, SDL_FLIP_NONE);
-    } else {
-        SDL_SetRenderDrawColor(ren, 30, 140, 230, 255);
-        SDL_RenderFillRect(ren, &dst);
-    }
+    // null texture -> flat placeholder quad in the tint colour
+    q.sprite(layer, tex, dst, heading_, tint);
 }
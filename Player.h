@@ -5,6 +5,8 @@
 #include <SDL3_image/SDL_image.h>
 #include <algorithm>
 #include "Map.h"
+class RenderQueue;
+enum class RenderLayer : uint8_t;
 
 
 class Player {
@@ -14,11 +16,12 @@ public:
 
     // inputs each frame: throttle [-1,1], brake [0,1], steer [-1,1] (L..R)
     void setInputs(float throttle, float brake, float steer);
-    void update(float dtSeconds, Map &map, int tileSize);
+    void update(float dtSeconds, const Map &map, int tileSize);
 
     // render the car rotated to its physical heading. ff tex == NULL, draws a placeholder.
-    void render(SDL_Renderer* ren, SDL_Texture* tex);
-    void render(SDL_Renderer* ren, SDL_Texture* tex, const Camera& cam);
+    void render(SDL_Renderer* ren, SDL_Texture* tex) const;
+    void render(RenderQueue& q, SDL_Texture* tex, const Camera& cam) const;
+    void render(RenderQueue& q, SDL_Texture* tex, const Camera& cam, RenderLayer layer, SDL_Color tint) const;
 
     // accessors / utilities
     void setPosition(float x, float y) { x_ = x; y_ = y; }
@@ -56,8 +59,8 @@ private:
     float maxSpeed_   = 1200.f;     // px/s
 
     // cached texture size for rendering
-    bool  haveSize_ = false;
-    float texW_ = 90.f, texH_ = 48.f;  // fallback if texture unknown
+    mutable bool  haveSize_ = false;
+    mutable float texW_ = 90.f, texH_ = 48.f;  // fallback if texture unknown
 
     static float clampf(float v, float lo, float hi);
     static float sgnf(float v);
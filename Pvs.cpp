@@ -0,0 +1,227 @@
+#include "Pvs.h"
+#include "Map.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdlib>
+#include <random>
+
+static constexpr int K = Pvs::kRegionSize;
+
+Pvs::Pvs(std::pmr::memory_resource* mem)
+: mem_(mem), opaque_(mem), region_(mem), bits_(mem) {}
+
+// Permissive field of view from one source tile, a quadrant at a time, in
+// quadrant coordinates: the source is the unit square at the origin, tile
+// (x, y) is [x, x+1] x [y, y+1] and lines of sight run up and to the right.
+// A view is a bundle of lines between a shallow and a steep bounding line;
+// each bounding line is pivoted on the obstacle corners ("bumps") that
+// narrowed the view, so it stays the extreme line that still starts in the
+// source. Views that close up to a single line are kept: grazing a corner
+// is a line of sight too.
+namespace {
+struct Line {
+    int xi, yi, xf, yf;
+    int64_t side(int x, int y) const { return int64_t(xf - xi) * (y - yi) - int64_t(yf - yi) * (x - xi); }
+    bool above(int x, int y) const { return side(x, y) > 0; }
+    bool below(int x, int y) const { return side(x, y) < 0; }
+};
+struct Bump { int x, y, parent; };
+struct View {
+    Line shallow, steep;
+    int  shallowBump{-1}, steepBump{-1};   // newest bump on each side, -1 = none
+};
+}
+
+struct Pvs::Fov {
+    std::pmr::vector<View> views;
+    std::pmr::vector<Bump> bumps;   // per quadrant; chains are shared by split views
+    explicit Fov(std::pmr::memory_resource* mem) : views(mem), bumps(mem) {}
+
+    void addShallowBump(View& v, int x, int y) {
+        v.shallow.xf = x;
+        v.shallow.yf = y;
+        bumps.push_back({ x, y, v.shallowBump });
+        v.shallowBump = int(bumps.size()) - 1;
+        for (int b = v.steepBump; b >= 0; b = bumps[b].parent)
+            if (v.shallow.below(bumps[b].x, bumps[b].y)) { v.shallow.xi = bumps[b].x; v.shallow.yi = bumps[b].y; }
+    }
+    void addSteepBump(View& v, int x, int y) {
+        v.steep.xf = x;
+        v.steep.yf = y;
+        bumps.push_back({ x, y, v.steepBump });
+        v.steepBump = int(bumps.size()) - 1;
+        for (int b = v.shallowBump; b >= 0; b = bumps[b].parent)
+            if (v.steep.above(bumps[b].x, bumps[b].y)) { v.steep.xi = bumps[b].x; v.steep.yi = bumps[b].y; }
+    }
+};
+
+int Pvs::rowCount(int a) const {
+    int count = 0;
+    for (size_t w = 0; w < words_; ++w) count += std::popcount(bits_[size_t(a) * words_ + w]);
+    return count;
+}
+
+void Pvs::scanQuadrant(Fov& fov, int r0, int c0, int dx, int dy, int region, int all) {
+    const int extentX = dx > 0 ? cols_ - 1 - c0 : c0;
+    const int extentY = dy > 0 ? rows_ - 1 - r0 : r0;
+    fov.views.clear();
+    fov.bumps.clear();
+    fov.views.push_back({ { 0, 1, extentX + 1, 0 }, { 1, 0, 0, extentY + 1 } });
+
+    for (int i = 1; i <= extentX + extentY && !fov.views.empty(); ++i) {
+        if (rowCount(region) == all) return;
+        size_t vi = 0;
+        // along the anti-diagonal, shallow to steep, like the views
+        for (int j = std::max(0, i - extentX); j <= std::min(i, extentY) && vi < fov.views.size(); ++j) {
+            const int x = i - j, y = j;
+            while (vi < fov.views.size() && !fov.views[vi].steep.below(x + 1, y)) ++vi;
+            if (vi == fov.views.size() || !fov.views[vi].shallow.above(x, y + 1)) continue;
+
+            const int c = c0 + x * dx, r = r0 + y * dy;
+            const int32_t seen = region_[size_t(r) * cols_ + c];
+            if (seen >= 0) {
+                set(region, seen);
+                set(seen, region);
+                continue;
+            }
+            View& v = fov.views[vi];
+            const bool shallowSide = v.shallow.below(x + 1, y);   // the tile closes the view from below
+            const bool steepSide   = v.steep.above(x, y + 1);     // ... from above
+            if (shallowSide && steepSide) {
+                fov.views.erase(fov.views.begin() + vi);
+            } else if (shallowSide) {
+                fov.addShallowBump(v, x, y + 1);
+            } else if (steepSide) {
+                fov.addSteepBump(v, x + 1, y);
+            } else {
+                // the tile splits the view: lines pass it on either side
+                const View copy = v;
+                fov.views.insert(fov.views.begin() + vi, copy);
+                fov.addSteepBump(fov.views[vi], x + 1, y);
+                fov.addShallowBump(fov.views[vi + 1], x, y + 1);
+            }
+        }
+    }
+}
+
+void Pvs::build(const Map& map) {
+    rows_ = map.rows();
+    cols_ = map.cols();
+    tile_ = map.tileSize();
+    const int n = rows_ * cols_;
+    opaque_.assign(n, 0);
+    for (int r = 0; r < rows_; ++r)
+        for (int c = 0; c < cols_; ++c)
+            opaque_[r * cols_ + c] = tileOpaque(map.tileAt(r, c)) ? 1 : 0;
+
+    // regions: see-through areas inside each sector
+    region_.assign(n, -1);
+    regionCount_ = 0;
+    std::pmr::vector<int> queue(mem_);
+    queue.reserve(n);
+    for (int t = 0; t < n; ++t) {
+        if (opaque_[t] || region_[t] >= 0) continue;
+        const int sr = (t / cols_) / K, sc = (t % cols_) / K;
+        const int id = regionCount_++;
+        queue.clear();
+        queue.push_back(t);
+        region_[t] = id;
+        for (size_t qi = 0; qi < queue.size(); ++qi) {
+            const int r = queue[qi] / cols_, c = queue[qi] % cols_;
+            const int nr[4] = { r - 1, r + 1, r, r };
+            const int nc[4] = { c, c, c - 1, c + 1 };
+            for (int k = 0; k < 4; ++k) {
+                if (nr[k] < 0 || nc[k] < 0 || nr[k] >= rows_ || nc[k] >= cols_) continue;
+                if (nr[k] / K != sr || nc[k] / K != sc) continue;
+                const int nt = nr[k] * cols_ + nc[k];
+                if (opaque_[nt] || region_[nt] >= 0) continue;
+                region_[nt] = id;
+                queue.push_back(nt);
+            }
+        }
+    }
+    const int R = regionCount_;
+
+    // see-through connectivity over the whole map, 8-connected since lines
+    // may cross at corners: a region sees at most the regions of its part
+    std::pmr::vector<int> comp(n, -1, mem_);
+    std::pmr::vector<int> regionComp(R, -1, mem_);
+    std::pmr::vector<int> compRegions(mem_);   // per part
+    for (int t = 0; t < n; ++t) {
+        if (opaque_[t] || comp[t] >= 0) continue;
+        const int id = int(compRegions.size());
+        compRegions.push_back(0);
+        queue.clear();
+        queue.push_back(t);
+        comp[t] = id;
+        for (size_t qi = 0; qi < queue.size(); ++qi) {
+            const int r = queue[qi] / cols_, c = queue[qi] % cols_;
+            int& rc = regionComp[region_[queue[qi]]];
+            if (rc < 0) {
+                rc = id;
+                ++compRegions[id];
+            }
+            for (int dr = -1; dr <= 1; ++dr)
+                for (int dc = -1; dc <= 1; ++dc) {
+                    const int rr = r + dr, cc = c + dc;
+                    if (rr < 0 || cc < 0 || rr >= rows_ || cc >= cols_) continue;
+                    const int nt = rr * cols_ + cc;
+                    if (opaque_[nt] || comp[nt] >= 0) continue;
+                    comp[nt] = id;
+                    queue.push_back(nt);
+                }
+        }
+    }
+
+    // A line of sight from region A to another region leaves A for good at a
+    // point of one of A's tiles, into a see-through tile of another region
+    // ahead of it: beside, above or below it, or diagonally. Scanning from
+    // such tiles finds every region A sees. Lines are symmetric, so only
+    // rightward ones are followed and each answer is set both ways. Once a
+    // row holds every region of its part there is nothing left to find.
+    words_ = size_t(R + 63) / 64;
+    bits_.assign(size_t(R) * words_, 0);
+    Fov fov(mem_);
+    auto leaves = [&](int r, int c, int id) {
+        if (r < 0 || c < 0 || r >= rows_ || c >= cols_) return false;
+        const int32_t other = region_[size_t(r) * cols_ + c];
+        return other >= 0 && other != id;
+    };
+    for (int t = 0; t < n; ++t) {
+        const int id = region_[t];
+        if (id < 0) continue;
+        set(id, id);
+        const int r = t / cols_, c = t % cols_;
+        const int all = compRegions[regionComp[id]];
+        for (int dy = -1; dy <= 1; dy += 2)
+            if (leaves(r, c + 1, id) || leaves(r + dy, c, id) || leaves(r + dy, c + 1, id))
+                scanQuadrant(fov, r, c, 1, dy, id, all);
+    }
+    visiblePairs_ = 0;
+    for (uint64_t w : bits_) visiblePairs_ += std::popcount(w);
+}
+
+int Pvs::verify(const Map& map, int pairs, uint32_t seed) const {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> col(0, cols_ - 1), row(0, rows_ - 1);
+    std::uniform_real_distribution<double> in(0.001, 0.999);   // clear of tile edges after rounding to float
+    auto point = [&](double& x, double& y) {
+        for (int tries = 0; tries < 1000; ++tries) {
+            const int c = col(rng), r = row(rng);
+            if (opaque(c, r)) continue;
+            x = c + in(rng);
+            y = r + in(rng);
+            return true;
+        }
+        return false;
+    };
+    int wrong = 0;
+    for (int i = 0; i < pairs; ++i) {
+        double ax, ay, bx, by;
+        if (!point(ax, ay) || !point(bx, by)) break;
+        const float px = float(ax * tile_), py = float(ay * tile_), qx = float(bx * tile_), qy = float(by * tile_);
+        if (map.lineOfSight(px, py, qx, qy) && !mayBeVisible(px, py, qx, qy)) ++wrong;
+    }
+    return wrong;
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include <SDL3/SDL.h>
+#include <cmath>
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+class Map;
+
+// Potentially visible sets, built once per level.
+//
+// The grid is cut into kRegionSize x kRegionSize sectors and each sector
+// into regions: its 4-connected see-through areas, so a walled room and
+// the space around it are separate regions. A region sees another if some
+// straight line from a point of one to a point of the other crosses no
+// opaque tile (grazing a corner is allowed). That is found with a
+// permissive field of view, which reaches every tile any point of the
+// source tile can see, run from each tile on a region's border. The answers
+// go in a bit matrix, one row of bits per region.
+//
+// mayBeVisible() is a table lookup: false means no point inside the tiles
+// of one region can see any point inside the other's, true means a ray is
+// still needed. Built from the tiles at load; later Map::setCell edits are
+// not tracked.
+class Pvs {
+public:
+    static constexpr int kRegionSize = 8;
+
+    explicit Pvs(std::pmr::memory_resource* mem = std::pmr::get_default_resource());
+
+    void build(const Map& map);
+
+    bool mayBeVisible(float ax, float ay, float bx, float by) const {
+        const int a = regionAt(ax, ay), b = regionAt(bx, by);
+        if (a < 0 || b < 0) return true;   // opaque or off the map: leave it to the ray
+        return (bits_[size_t(a) * words_ + (b >> 6)] >> (b & 63)) & 1u;
+    }
+
+    // Map::lineOfSight between random see-through points; returns how many
+    // clear ones mayBeVisible() rejected, which should be none.
+    int verify(const Map& map, int pairs, uint32_t seed) const;
+
+    int regionCount() const { return regionCount_; }
+    int visiblePairs() const { return visiblePairs_; }   // ordered, including each region with itself
+
+private:
+    int regionAt(float px, float py) const {
+        const int c = int(std::floor(px / float(tile_))), r = int(std::floor(py / float(tile_)));
+        if (r < 0 || c < 0 || r >= rows_ || c >= cols_) return -1;
+        return region_[size_t(r) * cols_ + c];
+    }
+    bool opaque(int c, int r) const { return r < 0 || c < 0 || r >= rows_ || c >= cols_ || opaque_[size_t(r) * cols_ + c]; }
+    struct Fov;
+    void scanQuadrant(Fov& fov, int r, int c, int dx, int dy, int region, int all);
+    int  rowCount(int a) const;
+    void set(int a, int b) { bits_[size_t(a) * words_ + (b >> 6)] |= uint64_t(1) << (b & 63); }
+
+    std::pmr::memory_resource* mem_;
+    int rows_{0}, cols_{0}, tile_{32};
+    int regionCount_{0}, visiblePairs_{0};
+    size_t words_{0};                    // per bit-matrix row
+    std::pmr::vector<uint8_t>  opaque_;  // per tile
+    std::pmr::vector<int32_t>  region_;  // per tile, -1 = opaque
+    std::pmr::vector<uint64_t> bits_;    // regionCount_ rows of words_
+};
@@ -0,0 +1,134 @@
+#include "RenderQueue.h"
+#include <algorithm>
+#include <cmath>
+
+static inline uint32_t packColor(SDL_Color c) {
+    return (uint32_t(c.r) << 24) | (uint32_t(c.g) << 16) | (uint32_t(c.b) << 8) | uint32_t(c.a);
+}
+
+void RenderQueue::reserve(size_t commands) {
+    cmds_.reserve(commands);
+    rects_.reserve(commands);
+    verts_.reserve(commands * 4);
+    indices_.reserve(commands * 6);
+    textures_.reserve(16);
+}
+
+uint16_t RenderQueue::textureId(SDL_Texture* tex) {
+    if (!tex) return 0;
+    for (size_t i = 0; i < textures_.size(); ++i)
+        if (textures_[i] == tex) return uint16_t(i + 1);
+    textures_.push_back(tex);
+    return uint16_t(textures_.size());
+}
+
+// key: layer(8) | texture id(16) | kind(8) | colour(32)
+void RenderQueue::push(RenderLayer layer, Kind kind, SDL_Texture* tex, const SDL_FRect& r, float angle, SDL_Color c) {
+    const uint64_t key = (uint64_t(layer) << 56) |
+                         (uint64_t(textureId(tex)) << 40) |
+                         (uint64_t(kind) << 32) |
+                         uint64_t(packColor(c));
+    cmds_.push_back({ key, uint32_t(cmds_.size()), kind, c, angle, r, tex });
+}
+
+void RenderQueue::fillRect(RenderLayer layer, const SDL_FRect& r, SDL_Color c) {
+    push(layer, Kind::Fill, nullptr, r, 0.f, c);
+}
+
+void RenderQueue::outlineRect(RenderLayer layer, const SDL_FRect& r, SDL_Color c) {
+    push(layer, Kind::Outline, nullptr, r, 0.f, c);
+}
+
+void RenderQueue::sprite(RenderLayer layer, SDL_Texture* tex, const SDL_FRect& dst, float angleDeg, SDL_Color tint) {
+    push(layer, Kind::Sprite, tex, dst, angleDeg, tint);
+}
+
+void RenderQueue::appendQuad(const Command& c, float dx, float dy) {
+    const float hw = c.rect.w * 0.5f, hh = c.rect.h * 0.5f;
+    const float cx = c.rect.x + hw + dx, cy = c.rect.y + hh + dy;
+    const float rad = c.angle * 3.14159265358979323846f / 180.f;
+    const float cs = std::cos(rad), sn = std::sin(rad);
+    const SDL_FColor col{ c.color.r / 255.f, c.color.g / 255.f, c.color.b / 255.f, c.color.a / 255.f };
+
+    // corners TL, TR, BR, BL; screen y points down so this rotates clockwise
+    const float ox[4] = { -hw,  hw, hw, -hw };
+    const float oy[4] = { -hh, -hh, hh,  hh };
+    const float u[4]  = { 0.f, 1.f, 1.f, 0.f };
+    const float v[4]  = { 0.f, 0.f, 1.f, 1.f };
+
+    const int base = int(verts_.size());
+    for (int i = 0; i < 4; ++i) {
+        verts_.push_back({ { cx + ox[i] * cs - oy[i] * sn, cy + ox[i] * sn + oy[i] * cs }, col, { u[i], v[i] } });
+    }
+    const int idx[6] = { 0, 1, 2, 0, 2, 3 };
+    for (int i : idx) indices_.push_back(base + i);
+}
+
+// conservative: a rotated quad stays inside the circle around its rect
+static inline bool touches(const SDL_FRect& r, const SDL_FRect* cull) {
+    if (!cull) return true;
+    const float pad = std::max(r.w, r.h) * 0.5f;
+    return r.x - pad < cull->x + cull->w && r.x + r.w + pad > cull->x &&
+           r.y - pad < cull->y + cull->h && r.y + r.h + pad > cull->y;
+}
+
+void RenderQueue::sort() {
+    stats_ = {};
+    stats_.commands = int(cmds_.size());
+
+    std::sort(cmds_.begin(), cmds_.end(), [](const Command& a, const Command& b) {
+        return a.key != b.key ? a.key < b.key : a.seq < b.seq;
+    });
+}
+
+void RenderQueue::submit(SDL_Renderer* r, float dx, float dy, const SDL_FRect* cull) {
+    // colour of sprites lives in the vertices, so only rect batches touch draw colour
+    bool haveColor = false;
+    uint32_t curColor = 0;
+
+    size_t i = 0;
+    while (i < cmds_.size()) {
+        const Command& first = cmds_[i];
+        size_t j = i;
+
+        if (first.kind == Kind::Sprite) {
+            // one geometry call per texture; tint can vary per vertex
+            verts_.clear();
+            indices_.clear();
+            const uint64_t group = first.key >> 32;
+            for (; j < cmds_.size() && (cmds_[j].key >> 32) == group; ++j)
+                if (touches(cmds_[j].rect, cull)) appendQuad(cmds_[j], dx, dy);
+            if (!verts_.empty()) {
+                SDL_RenderGeometry(r, first.tex, verts_.data(), int(verts_.size()), indices_.data(), int(indices_.size()));
+                ++stats_.batches;
+            }
+        } else {
+            rects_.clear();
+            for (; j < cmds_.size() && cmds_[j].key == first.key; ++j) {
+                if (!touches(cmds_[j].rect, cull)) continue;
+                SDL_FRect rc = cmds_[j].rect;
+                rc.x += dx;
+                rc.y += dy;
+                rects_.push_back(rc);
+            }
+            if (!rects_.empty()) {
+                const uint32_t c = packColor(first.color);
+                if (!haveColor || c != curColor) {
+                    SDL_SetRenderDrawColor(r, first.color.r, first.color.g, first.color.b, first.color.a);
+                    curColor = c;
+                    haveColor = true;
+                }
+                if (first.kind == Kind::Fill) SDL_RenderFillRects(r, rects_.data(), int(rects_.size()));
+                else                          SDL_RenderRects(r, rects_.data(), int(rects_.size()));
+                ++stats_.batches;
+            }
+        }
+        i = j;
+    }
+}
+
+void RenderQueue::flush(SDL_Renderer* r) {
+    sort();
+    submit(r);
+    clear();
+}
@@ -0,0 +1,67 @@
+#pragma once
+#include <SDL3/SDL.h>
+#include <cstdint>
+#include <vector>
+
+// Draw order buckets, lowest first. Within a layer commands are grouped by
+// texture, primitive and colour, and textures get their ids in first-seen
+// order each frame, so anything that must stack a fixed way needs its own
+// layer. Enemies draw over players, as they always have.
+enum class RenderLayer : uint8_t { Map, MapFog, FlagPole, Flag, FlagOutline, Ghosts, Players, Enemies, Hud };
+
+// Per-frame list of draw calls. Callers record compact POD commands in
+// screen space; flush() sorts them once by (layer, texture, kind, colour)
+// and submits each run as a single SDL_RenderFillRects / SDL_RenderRects /
+// SDL_RenderGeometry call, skipping redundant draw-colour changes.
+class RenderQueue {
+public:
+    struct Stats {
+        int commands = 0;
+        int batches  = 0;   // SDL submit calls issued since the last sort
+    };
+
+    RenderQueue() { reserve(1024); }
+    void reserve(size_t commands);
+
+    void fillRect(RenderLayer layer, const SDL_FRect& r, SDL_Color c);
+    void outlineRect(RenderLayer layer, const SDL_FRect& r, SDL_Color c);
+    // Textured quad rotated clockwise by angleDeg around its centre; with a
+    // null texture it is filled with `tint` instead.
+    void sprite(RenderLayer layer, SDL_Texture* tex, const SDL_FRect& dst, float angleDeg,
+                SDL_Color tint = {255, 255, 255, 255});
+
+    void flush(SDL_Renderer* r);   // sort + submit + clear
+    void clear() { cmds_.clear(); textures_.clear(); }
+
+    // Several views of one recording (split-screen): sort() once, then
+    // submit() per view, shifting everything by (dx, dy) and skipping
+    // commands that miss `cull` (in recorded coordinates); clear() after.
+    void sort();
+    void submit(SDL_Renderer* r, float dx = 0.f, float dy = 0.f, const SDL_FRect* cull = nullptr);
+
+    const Stats& stats() const { return stats_; }
+
+private:
+    enum class Kind : uint8_t { Fill, Outline, Sprite };
+
+    struct Command {
+        uint64_t     key;
+        uint32_t     seq;       // keeps submission order inside a run
+        Kind         kind;
+        SDL_Color    color;
+        float        angle;
+        SDL_FRect    rect;
+        SDL_Texture* tex;
+    };
+
+    uint16_t textureId(SDL_Texture* tex);
+    void push(RenderLayer layer, Kind kind, SDL_Texture* tex, const SDL_FRect& r, float angle, SDL_Color c);
+    void appendQuad(const Command& c, float dx, float dy);
+
+    std::vector<Command>      cmds_;
+    std::vector<SDL_Texture*> textures_;   // per-frame texture -> small id
+    std::vector<SDL_FRect>    rects_;      // scratch for rect batches
+    std::vector<SDL_Vertex>   verts_;      // scratch for geometry batches
+    std::vector<int>          indices_;
+    Stats                     stats_;
+};
@@ -0,0 +1,215 @@
+#include "Simulation.h"
+#include "Ghost.h"
+#include "Log.h"
+#include "MemoryStats.h"
+#include <cmath>
+
+static constexpr float kPlayerRadius = 12.0f;
+static constexpr float kEnemyRadius  = 15.0f;
+static constexpr float kFlagRadius   = 22.0f;
+
+static inline bool playerHitEnemy(const Player& p, const EnemyCar& e) {
+    const float dx = p.x() - e.x();
+    const float dy = p.y() - e.y();
+    const float r  = kPlayerRadius + kEnemyRadius;
+    return (dx*dx + dy*dy) <= (r * r);
+}
+
+static inline bool playerTouchesFlag(const Player& p, const Flag& f) {
+    float dx = p.x() - f.x, dy = p.y() - f.y;
+    return (dx*dx + dy*dy) <= kFlagRadius*kFlagRadius;
+}
+
+Simulation::Simulation(const Map& map, const NavGraph& nav, const Pvs& pvs, const WorldState& start,
+                       uint64_t inputSeq)
+: map_(map), nav_(nav), pvs_(pvs), state_(start), levelStart_(start), inputSeq_(inputSeq),
+  snapshots_(RenderSnapshot{ start, SimStatus::Running, inputSeq })
+{
+    history_.push(state_);
+}
+
+Simulation::~Simulation() { stop(); }
+
+void Simulation::start() {
+    if (running_.exchange(true)) return;
+    thread_ = std::thread(&Simulation::run, this);
+}
+
+void Simulation::stop() {
+    running_ = false;
+    if (thread_.joinable()) thread_.join();
+}
+
+void Simulation::requestRetry() {
+    retryRequested_.store(true, std::memory_order_release);
+}
+
+void Simulation::requestRewind(float seconds) {
+    rewindSeconds_.store(seconds, std::memory_order_release);
+}
+
+// Ticks are scheduled on the SDL_GetTicksNS clock, the one SDL stamps
+// events with, so tick n covers the input events stamped in (next - step, next].
+void Simulation::run() {
+    const Uint64 step = Uint64(1e9 / kTickRate);
+    Uint64 next = SDL_GetTicksNS();
+    brmem::Scope scope(MemTag::Entities);
+    brmem::AllocWatch watch("Sim tick");   // ticks run on fixed-size state only
+
+    while (running_.load(std::memory_order_relaxed) && status_ == SimStatus::Running) {
+        Uint64 now = SDL_GetTicksNS();
+        if (now < next) {
+            SDL_DelayNS(next - now);
+            continue;
+        }
+        // fell far behind (debugger, suspend): drop the backlog instead of spiralling
+        if (now - next > step * 8) next = now;
+
+        applyRequests();
+        tick(float(1.0 / kTickRate), next);
+        publish();
+        feedGhost();
+        watch.check();
+        next += step;
+    }
+}
+
+void Simulation::applyRequests() {
+    if (retryRequested_.exchange(false, std::memory_order_acquire)) {
+        state_ = levelStart_;
+        history_.clear();
+        history_.push(state_);
+        BR_LOG_INFO("Level retry");
+    }
+
+    const float rewind = rewindSeconds_.exchange(0.f, std::memory_order_acquire);
+    if (rewind > 0.f && history_.size() > 0) {
+        const size_t perEntry = size_t(kHistoryInterval);
+        size_t age = size_t(std::ceil(rewind * float(kTickRate) / float(perEntry)));
+        age = std::min(age, history_.size() - 1);
+        state_ = *history_.recent(age);
+        history_.drop(age);
+        BR_LOG_INFO("Rewound to tick {}", state_.tick);
+    }
+}
+
+// Players integrate in pieces split at the input events inside this tick,
+// so a key takes effect at its timestamp rather than at the next tick
+// boundary. Events whose tick already ran (the render thread only pumps
+// events once per frame) apply from the start of this one.
+void Simulation::stepPlayers(float dt, uint64_t endNs) {
+    const WorldState& w = state_;
+    const uint64_t beginNs = endNs - uint64_t(double(dt) * 1e9);
+    std::array<float, WorldState::kMaxPlayers> done{};   // seconds of this tick simulated so far
+
+    while (const InputEvent* e = input_.peek()) {
+        if (e->timeNs > endNs) break;   // belongs to a later tick
+        const int i = e->player;
+        if (i >= 0 && i < WorldState::kMaxPlayers) {
+            const float at = e->timeNs > beginNs ? float(double(e->timeNs - beginNs) * 1e-9) : 0.f;
+            if (i < w.playerCount && at > done[i]) {
+                advancePlayer(i, at - done[i]);
+                done[i] = at;
+            }
+            controls_[i] = *e;
+        }
+        inputSeq_ = e->seq;
+        input_.pop();
+    }
+    for (int i = 0; i < w.playerCount; ++i)
+        if (dt > done[i]) advancePlayer(i, dt - done[i]);
+}
+
+void Simulation::advancePlayer(int i, float dt) {
+    const InputEvent& c = controls_[i];
+    Player& p = state_.players[i];
+    p.setInputs(c.throttle, c.brake, c.steer);
+    p.update(dt, map_, map_.tileSize());
+}
+
+void Simulation::tick(float dt, uint64_t endNs) {
+    WorldState& w = state_;
+    ++w.tick;
+    w.elapsed += dt;
+
+    stepPlayers(dt, endNs);
+
+    // each enemy goes after the nearest player
+    for (auto& e : w.activeEnemies()) {
+        const Player* target = &w.players[0];
+        float best = 1e30f;
+        for (const Player& p : w.activePlayers()) {
+            const float dx = p.x() - e.x(), dy = p.y() - e.y();
+            if (dx*dx + dy*dy < best) { best = dx*dx + dy*dy; target = &p; }
+        }
+        e.update(dt, map_, nav_, pvs_, w.rng, target->x(), target->y());
+    }
+
+    // lives are shared: any player hitting any enemy costs one
+    const Player* crashed = nullptr;
+    for (const Player& p : w.activePlayers()) {
+        for (const auto& e : w.activeEnemies()) {
+            if (playerHitEnemy(p, e)) { crashed = &p; break; }
+        }
+        if (crashed) break;
+    }
+
+    if (crashed) {
+        w.lives--;
+        BR_LOG_INFO("Player {} crashed at ({}, {}), {} lives left",
+                    int(crashed - w.players.data()) + 1, crashed->x(), crashed->y(), w.lives);
+
+        if (w.lives > 0) {
+            // Respawn player and enemies at the level spawns in one block copy
+            w.restoreActors(levelStart_);
+        } else {
+            status_ = SimStatus::Lost;
+            BR_LOG_INFO("Game over at tick {}", w.tick);
+            return;
+        }
+    }
+
+    // Collect
+    bool allTaken = true;
+    for (auto& f : w.activeFlags()) {
+        for (const Player& p : w.activePlayers()) {
+            if (!f.taken && playerTouchesFlag(p, f)) {
+                f.taken = true;
+                BR_LOG_INFO("Flag collected at ({}, {})", f.x, f.y);
+            }
+        }
+        allTaken = allTaken && f.taken;
+    }
+    if (allTaken) {
+        status_ = SimStatus::Won;
+        BR_LOG_INFO("All flags collected at tick {}", w.tick);
+    }
+
+    if (w.tick % kHistoryInterval == 0) history_.push(w);
+}
+
+// Player 0 every kSampleTicks, and the tick the run was won or lost on.
+// Retry and rewind show up as the tick going backwards.
+void Simulation::feedGhost() {
+    if (!ghosts_) return;
+    const WorldState& w = state_;
+    GhostEvent e;
+    e.kind = status_ == SimStatus::Won  ? GhostEvent::Kind::Won
+           : status_ == SimStatus::Lost ? GhostEvent::Kind::Lost
+                                        : GhostEvent::Kind::Sample;
+    if (e.kind == GhostEvent::Kind::Sample && w.tick % GhostFeed::kSampleTicks != 0) return;
+    const Player& p = w.players[0];
+    e.tick = w.tick;
+    e.x = p.x();
+    e.y = p.y();
+    e.headingDeg = p.heading();
+    ghosts_->push(e);
+}
+
+void Simulation::publish() {
+    RenderSnapshot& s = snapshots_.back();
+    s.world  = state_;
+    s.status = status_;
+    s.inputSeq = inputSeq_;
+    snapshots_.publish();
+}
@@ -0,0 +1,84 @@
+#pragma once
+#include <SDL3/SDL.h>
+#include <array>
+#include <atomic>
+#include <thread>
+#include "InputQueue.h"
+#include "WorldState.h"
+#include "NavGraph.h"
+#include "Pvs.h"
+#include "TripleBuffer.h"
+class GhostFeed;
+
+enum class SimStatus { Running, Won, Lost };
+
+// Everything the render thread needs for one frame, copied out once per tick.
+struct RenderSnapshot {
+    WorldState world;
+    SimStatus  status{SimStatus::Running};
+    uint64_t   inputSeq{0};   // newest InputEvent::seq this state includes
+};
+
+// Runs player/enemy updates, collisions and pickups on its own thread at a
+// fixed tick rate, publishing a RenderSnapshot after every tick.
+class Simulation {
+public:
+    static constexpr double kTickRate = 120.0;
+    static constexpr int    kHistoryInterval = 60;  // ticks between rollback snapshots
+    static constexpr int    kHistorySize     = 32;  // ~16 s of rollback at 120 Hz
+
+    // Holds on to the level's map, nav graph and PVS: build one per level and
+    // destroy it before that level is unloaded. `inputSeq` is the newest
+    // input already accounted for, so latency tracking carries across levels.
+    Simulation(const Map& map, const NavGraph& nav, const Pvs& pvs, const WorldState& start,
+               uint64_t inputSeq = 0);
+    ~Simulation();
+
+    Simulation(const Simulation&) = delete;
+    Simulation& operator=(const Simulation&) = delete;
+
+    void start();
+    void stop();
+
+    // main thread -> sim thread; events must arrive in timestamp order.
+    // Each takes effect at its own time inside the tick that covers it.
+    bool pushInput(const InputEvent& e) { return input_.push(e); }
+    // sim thread -> ghost writer: player 0's run, for the time trial; only while stopped
+    void setGhostFeed(GhostFeed* feed) { ghosts_ = feed; }
+    void requestRetry();                  // restore the level-start state
+    void requestRewind(float seconds);    // roll back through the history ring
+
+    // newest published state; call from the render thread only
+    const RenderSnapshot& latest() { return snapshots_.front(); }
+
+private:
+    void run();
+    void tick(float dt, uint64_t endNs);
+    void stepPlayers(float dt, uint64_t endNs);
+    void advancePlayer(int i, float dt);
+    void applyRequests();
+    void publish();
+    void feedGhost();
+
+    const Map&      map_;
+    const NavGraph& nav_;
+    const Pvs&      pvs_;
+
+    // sim-thread state
+    WorldState     state_;
+    WorldState     levelStart_;
+    WorldStateRing history_{kHistorySize};
+    SimStatus      status_{SimStatus::Running};
+    std::array<InputEvent, WorldState::kMaxPlayers> controls_{};   // current per-player controls
+    uint64_t       inputSeq_{0};
+    GhostFeed*     ghosts_{nullptr};
+
+    // shared with the main thread
+    InputQueue         input_;
+    std::atomic<bool>  retryRequested_{false};
+    std::atomic<float> rewindSeconds_{0.f};
+    std::atomic<bool>  running_{false};
+
+    TripleBuffer<RenderSnapshot> snapshots_;
+    std::thread                  thread_;
+};
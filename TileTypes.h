@@ -0,0 +1,90 @@
+#pragma once
+#include <array>
+#include <cstdint>
+
+// Terrain types stored in the Map grid. Values are the raw grid bytes, so
+// Empty/Wall keep the old 0/1 meaning.
+enum class TileType : uint8_t { Empty = 0, Wall = 1, Dirt = 2, Fence = 3, Count };
+
+// Which sprite Map::render uses for a tile.
+enum class TileSprite : uint8_t { None, Wall, Dirt, Fence, Count };
+
+struct TileInfo {
+    char       glyph;       // character in level files
+    bool       solid;       // blocks cars
+    float      friction;    // multiplier on rolling resistance and drag
+    bool       opaque;      // blocks line of sight
+    TileSprite sprite;
+    uint32_t   mapColor;    // 0xRRGGBBAA in zoomed-out map views
+};
+
+// Legend + properties, one row per TileType (order must match the enum).
+inline constexpr std::array<TileInfo, size_t(TileType::Count)> kTileInfo{{
+    /* Empty */ { '.', false, 1.0f, false, TileSprite::None,  0x00000000u },
+    /* Wall  */ { '#', true,  1.0f, true,  TileSprite::Wall,  0x00FF00FFu },
+    /* Dirt  */ { 'd', false, 4.0f, false, TileSprite::Dirt,  0x785430FFu },
+    /* Fence */ { 'x', true,  1.0f, false, TileSprite::Fence, 0xAAAAAA60u },
+}};
+
+// 256-entry character -> TileType table; anything not in the legend
+// (spaces, spawn markers like P/E/F) decodes to Empty.
+inline constexpr std::array<TileType, 256> kTileDecode = [] {
+    std::array<TileType, 256> t{};
+    for (auto& v : t) v = TileType::Empty;
+    for (size_t i = 0; i < kTileInfo.size(); ++i)
+        t[uint8_t(kTileInfo[i].glyph)] = TileType(i);
+    return t;
+}();
+
+// Per-property flat tables indexed by the raw tile byte, so a query is one
+// load with no branch on the type. Bytes outside the enum read as Empty.
+enum class TileProperty { Solid, Friction, Opaque, Sprite, MapColor };
+
+template <TileProperty P> struct TilePropertyTraits;
+template <> struct TilePropertyTraits<TileProperty::Solid> {
+    using type = bool;
+    static constexpr type get(const TileInfo& i) { return i.solid; }
+};
+template <> struct TilePropertyTraits<TileProperty::Friction> {
+    using type = float;
+    static constexpr type get(const TileInfo& i) { return i.friction; }
+};
+template <> struct TilePropertyTraits<TileProperty::Opaque> {
+    using type = bool;
+    static constexpr type get(const TileInfo& i) { return i.opaque; }
+};
+template <> struct TilePropertyTraits<TileProperty::Sprite> {
+    using type = TileSprite;
+    static constexpr type get(const TileInfo& i) { return i.sprite; }
+};
+template <> struct TilePropertyTraits<TileProperty::MapColor> {
+    using type = uint32_t;
+    static constexpr type get(const TileInfo& i) { return i.mapColor; }
+};
+
+template <TileProperty P>
+inline constexpr auto kTileTable = [] {
+    using Traits = TilePropertyTraits<P>;
+    std::array<typename Traits::type, 256> t{};
+    for (size_t i = 0; i < t.size(); ++i)
+        t[i] = Traits::get(kTileInfo[i < kTileInfo.size() ? i : 0]);
+    return t;
+}();
+
+template <TileProperty P>
+constexpr typename TilePropertyTraits<P>::type tileProperty(TileType t) {
+    return kTileTable<P>[uint8_t(t)];
+}
+
+constexpr TileType   decodeTile(char ch)      { return kTileDecode[uint8_t(ch)]; }
+constexpr bool       tileSolid(TileType t)    { return tileProperty<TileProperty::Solid>(t); }
+constexpr float      tileFriction(TileType t) { return tileProperty<TileProperty::Friction>(t); }
+constexpr bool       tileOpaque(TileType t)   { return tileProperty<TileProperty::Opaque>(t); }
+constexpr TileSprite tileSprite(TileType t)   { return tileProperty<TileProperty::Sprite>(t); }
+constexpr uint32_t   tileMapColor(TileType t) { return tileProperty<TileProperty::MapColor>(t); }
+
+static_assert(decodeTile('#') == TileType::Wall && decodeTile('.') == TileType::Empty &&
+              decodeTile(' ') == TileType::Empty && decodeTile('P') == TileType::Empty,
+              "level legend changed");
+static_assert(tileSolid(TileType::Wall) && !tileSolid(TileType::Dirt) && tileOpaque(TileType::Wall) &&
+              !tileOpaque(TileType::Fence), "tile table out of sync with TileType");
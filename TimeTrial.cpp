@@ -0,0 +1,147 @@
+#include "TimeTrial.h"
+#include "Log.h"
+#include "MemoryStats.h"
+#include "RenderQueue.h"
+#include "Simulation.h"
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+static constexpr int kTickRate = int(Simulation::kTickRate);
+
+static std::vector<fs::path> listRuns(const std::string& dir) {
+    std::vector<fs::path> out;
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(dir, ec))
+        if (entry.is_regular_file() && entry.path().extension() == ".ghost") out.push_back(entry.path());
+    std::sort(out.begin(), out.end());   // zero-padded tick counts: fastest first
+    return out;
+}
+
+void TimeTrial::beginLevel(const std::string& levelPath, bool record) {
+    brmem::Scope scope(MemTag::Ghosts);
+    stop();
+    dir_ = (fs::path("ghosts") / fs::path(levelPath).stem()).generic_string();
+
+    ghosts_.clear();
+    for (const fs::path& p : listRuns(dir_)) {
+        if (int(ghosts_.size()) >= maxGhosts_) break;
+        Ghost g;
+        if (g.load(p.generic_string(), kTickRate)) ghosts_.push_back(std::move(g));
+        else BR_LOG_WARN("Skipping unreadable ghost {}", p.generic_string());
+    }
+    ghosts_.shrink_to_fit();
+    bestTick_ = ghosts_.empty() ? 0 : ghosts_.front().endTick();
+
+    if (record) {
+        lastTick_ = 0;
+        failed_ = false;
+        stopping_.store(false, std::memory_order_relaxed);
+        thread_ = std::thread(&TimeTrial::write, this);
+    }
+    if (ghosts_.empty()) return;
+
+    size_t bytes = 0;
+    uint64_t ticks = 0;
+    for (const Ghost& g : ghosts_) {
+        bytes += g.bytes();
+        ticks += g.endTick();
+    }
+    const double minutes = double(ticks) / Simulation::kTickRate / 60.0;
+    BR_LOG_INFO("Ghosts: {} runs, best {} s, {} KiB in memory",
+                ghosts_.size(), double(bestTick_) / Simulation::kTickRate, bytes / 1024);
+    BR_LOG_INFO("Ghosts: {} bytes per ghost-minute", minutes > 0.0 ? double(bytes) / minutes : 0.0);
+}
+
+void TimeTrial::stop() {
+    if (thread_.joinable()) {
+        stopping_.store(true, std::memory_order_release);
+        feed_.wake();
+        thread_.join();
+    }
+    GhostEvent e;
+    while (feed_.pop(e)) {}   // fed while not recording
+}
+
+void TimeTrial::write() {
+    brmem::Scope scope(MemTag::Ghosts);
+    for (;;) {
+        const uint32_t seen = feed_.wakes();
+        const bool stopping = stopping_.load(std::memory_order_acquire);
+        GhostEvent e;
+        while (feed_.pop(e)) take(e);
+        if (stopping) break;
+        feed_.wait(seen);
+    }
+    writer_.abort();
+}
+
+void TimeTrial::take(const GhostEvent& e) {
+    if (writer_.active() && e.tick <= lastTick_) writer_.abort();   // retry or rewind: this run is over
+    lastTick_ = e.tick;
+
+    if (e.kind == GhostEvent::Kind::Lost) {
+        writer_.abort();
+        return;
+    }
+    if (!writer_.active()) {
+        // only runs driven from the start count; after a rewind wait for a retry
+        if (e.kind != GhostEvent::Kind::Sample || e.tick > kStartTicks || failed_) return;
+        std::error_code ec;
+        fs::create_directories(dir_, ec);
+        if (!writer_.begin(dir_ + "/run.tmp", kTickRate)) {
+            BR_LOG_WARN("Cannot record ghost runs in {}", dir_);
+            failed_ = true;
+            return;
+        }
+    }
+    writer_.add(e.tick, e.x, e.y, e.headingDeg);
+    if (e.kind == GhostEvent::Kind::Won) keep(e.tick);
+}
+
+void TimeTrial::keep(uint64_t tick) {
+    if (!writer_.finish()) {
+        BR_LOG_WARN("Writing the ghost run to {} failed", dir_);
+        return;
+    }
+
+    const double seconds = double(tick) / Simulation::kTickRate;
+    char name[32];
+    std::snprintf(name, sizeof name, "%08llu.ghost", (unsigned long long)tick);
+    fs::path dst = fs::path(dir_) / name;
+    std::error_code ec;
+    for (int n = 2; fs::exists(dst, ec) && n < 100; ++n) {
+        std::snprintf(name, sizeof name, "%08llu-%d.ghost", (unsigned long long)tick, n);
+        dst = fs::path(dir_) / name;
+    }
+    fs::rename(fs::path(dir_) / "run.tmp", dst, ec);
+    if (ec) {
+        BR_LOG_WARN("Cannot keep the ghost run: {}", ec.message());
+        return;
+    }
+    BR_LOG_INFO("Run {} s: {} samples, {} bytes on disk", seconds, writer_.samples(), writer_.bytes());
+    if (bestTick_ == 0 || tick < bestTick_) BR_LOG_INFO("New best time");
+
+    const std::vector<fs::path> runs = listRuns(dir_);
+    for (size_t i = kKeepRuns; i < runs.size(); ++i) fs::remove(runs[i], ec);
+}
+
+void TimeTrial::render(RenderQueue& q, SDL_Texture* tex, const Camera& cam, uint64_t tick,
+                       std::span<const SDL_FRect> views) {
+    // one layer under the real cars, all sharing the player texture: a single batch
+    const SDL_Color tint = tex ? SDL_Color{255, 255, 255, 110} : SDL_Color{200, 200, 200, 110};
+    constexpr float margin = 64.f;
+    for (Ghost& g : ghosts_) {
+        float x = 0.f, y = 0.f, heading = 0.f;
+        if (!g.at(double(tick), x, y, heading)) continue;
+        bool seen = false;
+        for (const SDL_FRect& v : views)
+            seen |= x >= v.x - margin && x <= v.x + v.w + margin && y >= v.y - margin && y <= v.y + v.h + margin;
+        if (!seen) continue;
+        car_.setPosition(x, y);
+        car_.setHeading(heading);
+        car_.render(q, tex, cam, RenderLayer::Ghosts, tint);
+    }
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <SDL3/SDL.h>
+#include <atomic>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Ghost.h"
+#include "Player.h"
+class RenderQueue;
+
+// Time trial against earlier runs. A single-player run is recorded while
+// it is driven, into ghosts/<level>/run.tmp; when the level is won it is
+// kept as <ticks>.ghost, so file-name order is fastest first. Loading a
+// level loads its fastest maxGhosts runs, which race along on the
+// simulation clock: retry and rewind move them too.
+//
+// The simulation samples the run into feed(); a background thread writes
+// it out and keeps or deletes it, so the render thread never waits on disk.
+class TimeTrial {
+public:
+    static constexpr size_t   kKeepRuns   = 64;   // slower runs are deleted
+    static constexpr uint64_t kStartTicks = 30;   // a run seen later than this was joined late
+
+    TimeTrial() = default;
+    ~TimeTrial() { stop(); }
+    TimeTrial(const TimeTrial&) = delete;
+    TimeTrial& operator=(const TimeTrial&) = delete;
+
+    void setMaxGhosts(int n) { maxGhosts_ = n; }
+    // Loads the level's ghosts and, if record, starts writing runs fed for it.
+    // The simulation must be stopped so the previous level's feed is complete.
+    void beginLevel(const std::string& levelPath, bool record);
+    void stop();   // writes out what was fed; an unfinished run is not kept
+
+    GhostFeed& feed() { return feed_; }
+
+    void render(RenderQueue& q, SDL_Texture* tex, const Camera& cam, uint64_t tick,
+                std::span<const SDL_FRect> views);
+    size_t ghostCount() const { return ghosts_.size(); }
+
+private:
+    void write();
+    void take(const GhostEvent& e);
+    void keep(uint64_t tick);
+
+    std::string        dir_;
+    std::vector<Ghost> ghosts_;
+    int                maxGhosts_{32};
+    uint64_t           bestTick_{0};   // of the loaded runs, 0 = none
+    Player             car_;   // stand-in so ghosts draw exactly like players
+
+    // writer thread
+    GhostFeed          feed_;
+    GhostWriter        writer_;
+    uint64_t           lastTick_{0};
+    bool               failed_{false};
+    std::atomic<bool>  stopping_{false};
+    std::thread        thread_;
+};
@@ -0,0 +1,36 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+// Lock-free single-producer / single-consumer triple buffer.
+// The writer fills back() and publish()es it; the reader always gets the
+// newest published slot from front() without ever waiting on the writer.
+template <typename T>
+class TripleBuffer {
+public:
+    TripleBuffer() = default;
+    explicit TripleBuffer(const T& init) { slots_.fill(init); }
+
+    // writer side
+    T& back() { return slots_[back_]; }
+    void publish() {
+        back_ = middle_.exchange(uint8_t(back_ | kFresh), std::memory_order_acq_rel) & kIndex;
+    }
+
+    // reader side: swaps in the newest slot if one was published since last call
+    const T& front() {
+        if (middle_.load(std::memory_order_relaxed) & kFresh)
+            front_ = middle_.exchange(front_, std::memory_order_acq_rel) & kIndex;
+        return slots_[front_];
+    }
+
+private:
+    static constexpr uint8_t kIndex = 0x3;
+    static constexpr uint8_t kFresh = 0x4;
+
+    std::array<T, 3>     slots_{};
+    uint8_t              back_{0};              // owned by the writer
+    alignas(64) std::atomic<uint8_t> middle_{1}; // shared hand-off slot + fresh bit
+    alignas(64) uint8_t  front_{2};             // owned by the reader
+};
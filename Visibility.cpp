@@ -0,0 +1,107 @@
+#include "Visibility.h"
+#include "Map.h"
+#include <algorithm>
+#include <cmath>
+
+Visibility::Visibility(std::pmr::memory_resource* mem) : visible_(mem), explored_(mem) {}
+
+void Visibility::reset(const Map& map) {
+    rows_ = map.rows();
+    cols_ = map.cols();
+    tile_ = map.tileSize();
+    const size_t words = (size_t(rows_) * cols_ + 63) / 64;
+    visible_.assign(words, 0);
+    explored_.assign(words, 0);
+    viewerCount_ = 0;
+    visibleCount_ = 0;
+    ++version_;
+}
+
+bool Visibility::visibleAtPixel(float px, float py) const {
+    return visible(int(std::floor(py / tile_)), int(std::floor(px / tile_)));
+}
+
+bool Visibility::exploredAtPixel(float px, float py) const {
+    return explored(int(std::floor(py / tile_)), int(std::floor(px / tile_)));
+}
+
+void Visibility::mark(int row, int col) {
+    const int i = row * cols_ + col;
+    const uint64_t bit = uint64_t(1) << (i & 63);
+    if (!(visible_[i >> 6] & bit)) {
+        visible_[i >> 6] |= bit;
+        ++visibleCount_;
+    }
+}
+
+bool Visibility::update(const Map& map, float px, float py) {
+    const SDL_FPoint p{px, py};
+    return update(map, std::span<const SDL_FPoint>(&p, 1));
+}
+
+bool Visibility::update(const Map& map, std::span<const SDL_FPoint> viewers) {
+    const int n = std::min(int(viewers.size()), kMaxViewers);
+    std::array<int, kMaxViewers> tiles{};
+    for (int i = 0; i < n; ++i)
+        tiles[i] = int(std::floor(viewers[i].y / tile_)) * cols_ + int(std::floor(viewers[i].x / tile_));
+    if (n == viewerCount_ && std::equal(tiles.begin(), tiles.begin() + n, viewerTiles_.begin())) return false;
+    viewerTiles_ = tiles;
+    viewerCount_ = n;
+    ++version_;
+
+    std::fill(visible_.begin(), visible_.end(), 0);
+    visibleCount_ = 0;
+
+    // octant transforms: (dx, dy) in octant space -> (col, row) offsets
+    static constexpr int kOct[8][4] = {
+        { 1,  0,  0,  1 }, { 0,  1,  1,  0 }, { 0, -1,  1,  0 }, { -1, 0,  0,  1 },
+        { -1, 0,  0, -1 }, { 0, -1, -1,  0 }, { 0,  1, -1,  0 }, { 1,  0,  0, -1 },
+    };
+    for (int i = 0; i < n; ++i) {
+        originRow_ = int(std::floor(viewers[i].y / tile_));
+        originCol_ = int(std::floor(viewers[i].x / tile_));
+        if (originRow_ < 0 || originCol_ < 0 || originRow_ >= rows_ || originCol_ >= cols_) continue;
+        mark(originRow_, originCol_);
+        for (const auto& o : kOct) castOctant(map, 1, 1.f, 0.f, o[0], o[1], o[2], o[3]);
+    }
+
+    for (size_t i = 0; i < visible_.size(); ++i) explored_[i] |= visible_[i];
+    return true;
+}
+
+// Scans rows (distance from the origin) of one octant, tracking the slope
+// interval [end, start] that is still lit; an opaque run splits it and the
+// part left of the blocker continues in a recursive call.
+void Visibility::castOctant(const Map& map, int row, float start, float end, int xx, int xy, int yx, int yy) {
+    if (start < end) return;
+    const int r2 = kRadius * kRadius;
+    float newStart = 0.f;
+
+    for (int j = row; j <= kRadius; ++j) {
+        bool blocked = false;
+        const int dy = -j;
+        for (int dx = -j; dx <= 0; ++dx) {
+            const float lSlope = (float(dx) - 0.5f) / (float(dy) + 0.5f);
+            const float rSlope = (float(dx) + 0.5f) / (float(dy) - 0.5f);
+            if (start < rSlope) continue;
+            if (end > lSlope) break;
+
+            const int c = originCol_ + dx * xx + dy * xy;
+            const int r = originRow_ + dx * yx + dy * yy;
+            const bool inside = r >= 0 && c >= 0 && r < rows_ && c < cols_;
+            if (inside && dx * dx + dy * dy <= r2) mark(r, c);
+
+            const bool opaque = !inside || tileOpaque(map.tileAt(r, c));
+            if (blocked) {
+                if (opaque) { newStart = rSlope; continue; }
+                blocked = false;
+                start = newStart;
+            } else if (opaque && j < kRadius) {
+                blocked = true;
+                castOctant(map, j + 1, start, lSlope, xx, xy, yx, yy);
+                newStart = rSlope;
+            }
+        }
+        if (blocked) break;
+    }
+}
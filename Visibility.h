@@ -0,0 +1,56 @@
+#pragma once
+#include <SDL3/SDL.h>
+#include <array>
+#include <cstdint>
+#include <memory_resource>
+#include <span>
+#include <vector>
+class Map;
+
+// Which tiles the players can see right now, and which they have seen at
+// some point this level, as one bit per tile.
+//
+// Visible tiles come from recursive shadowcasting (8 octants) out of each
+// viewer's tile, limited to kRadius tiles; opaque tiles stop the light
+// (fences do not). With several viewers (split-screen) the result is the
+// union. update() only recasts when some viewer enters a new tile.
+class Visibility {
+public:
+    static constexpr int kRadius = 20;   // tiles
+    static constexpr int kMaxViewers = 4;
+
+    explicit Visibility(std::pmr::memory_resource* mem = std::pmr::get_default_resource());
+
+    // size for the map and forget everything explored
+    void reset(const Map& map);
+    // recast from the viewers' positions if any crossed into another tile;
+    // returns whether the visible set was recomputed
+    bool update(const Map& map, std::span<const SDL_FPoint> viewers);
+    bool update(const Map& map, float px, float py);
+
+    bool visible(int row, int col) const  { return test(visible_, row, col); }
+    bool explored(int row, int col) const { return test(explored_, row, col); }
+    bool visibleAtPixel(float px, float py) const;
+    bool exploredAtPixel(float px, float py) const;
+
+    int visibleCount() const { return visibleCount_; }
+    uint32_t version() const { return version_; }   // bumped on every recast
+
+private:
+    bool test(const std::pmr::vector<uint64_t>& bits, int row, int col) const {
+        if (row < 0 || col < 0 || row >= rows_ || col >= cols_) return false;
+        const int i = row * cols_ + col;
+        return (bits[i >> 6] >> (i & 63)) & 1u;
+    }
+    void mark(int row, int col);
+    void castOctant(const Map& map, int row, float start, float end, int xx, int xy, int yx, int yy);
+
+    int rows_{0}, cols_{0}, tile_{32};
+    int originRow_{0}, originCol_{0};              // viewer being cast
+    std::array<int, kMaxViewers> viewerTiles_{};   // tile index per viewer at the last cast
+    int viewerCount_{0};
+    int visibleCount_{0};
+    uint32_t version_{0};
+    std::pmr::vector<uint64_t> visible_;
+    std::pmr::vector<uint64_t> explored_;
+};
@@ -0,0 +1,111 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+#include <vector>
+#include "Player.h"
+#include "EnemyCar.h"
+
+struct Flag {
+    float x, y;
+    bool  taken = false;
+};
+
+// Small deterministic generator (xorshift32) whose state lives in the world
+// snapshot, so restoring a snapshot also replays the same AI decisions.
+struct Rng {
+    uint32_t state{0x9E3779B9u};
+
+    void seed(uint32_t s) { state = s ? s : 0x9E3779B9u; }
+    uint32_t next() {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+    int range(int n) { return int(next() % uint32_t(n)); } // [0, n)
+};
+
+// Complete simulation state for one level in a single flat, trivially
+// copyable block: saving or restoring it is one memcpy, no allocation.
+struct WorldState {
+    static constexpr int kMaxPlayers = 4;    // local split-screen
+    static constexpr int kMaxEnemies = 64;
+    static constexpr int kMaxFlags   = 64;
+
+    std::array<Player, kMaxPlayers>    players{};
+    int                                playerCount{1};
+    std::array<EnemyCar, kMaxEnemies>  enemies{};
+    int                                enemyCount{0};
+    std::array<Flag, kMaxFlags>        flags{};
+    int                                flagCount{0};
+    int                                lives{0};
+    uint64_t                           tick{0};
+    float                              elapsed{0.f};   // seconds since level start
+    Rng                                rng;
+
+    bool addEnemy(const EnemyCar& e) {
+        if (enemyCount >= kMaxEnemies) return false;
+        enemies[enemyCount++] = e;
+        return true;
+    }
+    bool addFlag(const Flag& f) {
+        if (flagCount >= kMaxFlags) return false;
+        flags[flagCount++] = f;
+        return true;
+    }
+
+    std::span<Player>         activePlayers()       { return { players.data(), size_t(playerCount) }; }
+    std::span<const Player>   activePlayers() const { return { players.data(), size_t(playerCount) }; }
+    std::span<EnemyCar>       activeEnemies()       { return { enemies.data(), size_t(enemyCount) }; }
+    std::span<const EnemyCar> activeEnemies() const { return { enemies.data(), size_t(enemyCount) }; }
+    std::span<Flag>           activeFlags()         { return { flags.data(), size_t(flagCount) }; }
+    std::span<const Flag>     activeFlags() const   { return { flags.data(), size_t(flagCount) }; }
+
+    // Put the players and every enemy back where `start` had them, keeping
+    // flags, lives, timers and RNG as they are now (a respawn, not a retry).
+    void restoreActors(const WorldState& start) {
+        players = start.players;
+        playerCount = start.playerCount;
+        enemies = start.enemies;
+        enemyCount = start.enemyCount;
+    }
+};
+
+static_assert(std::is_trivially_copyable_v<WorldState>, "WorldState must stay memcpy-able");
+
+// Fixed ring of recent world states for rollback; storage is allocated once.
+class WorldStateRing {
+public:
+    explicit WorldStateRing(size_t capacity) : slots_(capacity) {}
+
+    void push(const WorldState& s) {
+        slots_[head_] = s;
+        head_ = (head_ + 1) % slots_.size();
+        if (count_ < slots_.size()) ++count_;
+    }
+
+    // age 0 = newest; nullptr if the ring does not reach back that far
+    const WorldState* recent(size_t age) const {
+        if (age >= count_) return nullptr;
+        return &slots_[(head_ + slots_.size() - 1 - age) % slots_.size()];
+    }
+
+    // forget the newest `n` entries (after rewinding past them)
+    void drop(size_t n) {
+        n = std::min(n, count_);
+        head_ = (head_ + slots_.size() - n) % slots_.size();
+        count_ -= n;
+    }
+
+    void clear() { head_ = 0; count_ = 0; }
+    size_t size() const { return count_; }
+    size_t capacity() const { return slots_.size(); }
+
+private:
+    std::vector<WorldState> slots_;
+    size_t head_{0};
+    size_t count_{0};
+};
@@ -1,14 +1,29 @@
 #include <SDL3/SDL.h>
 #include <SDL3_image/SDL_image.h>
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <array>
+#include <memory>
+#include <span>
 #include <algorithm>
 #include <cmath>
 #include "Player.h"
 #include "Map.h"
 #include "Camera.h"
 #include "EnemyCar.h"
+#include "Simulation.h"
+#include "Log.h"
+#include "RenderQueue.h"
+#include "NavGraph.h"
+#include "Level.h"
+#include "DynamicResolution.h"
+#include "FrameCapture.h"
+#include "TimeTrial.h"
+#include "InputLatency.h"
+#include "MapLod.h"
+#include "MemoryStats.h"
 #include <vector>
-#include <fstream>
 #include <string>
 
 struct SDLState {
@@ -21,105 +36,79 @@ struct SDLState {
 // Set tile size
 static const int TILE = 32;
 
-struct Flag {
-    float x, y;
-    bool  taken = false;
-};
-
-static inline void renderFlag(SDL_Renderer* r, const Camera& cam, const Flag& f) {
+static inline void renderFlag(RenderQueue& q, const Camera& cam, const Flag& f) {
     if (f.taken) return;
     const float s = 16.f;
     SDL_FRect fr{ f.x - cam.view.x - s*0.5f, f.y - cam.view.y - s*0.5f, s, s };
     // pole
-    SDL_SetRenderDrawColor(r, 210, 210, 210, 255);
     SDL_FRect pole{ fr.x + fr.w * 0.45f, fr.y - 8.f, 3.f, fr.h + 8.f };
-    SDL_RenderFillRect(r, &pole);
+    q.fillRect(RenderLayer::FlagPole, pole, {210, 210, 210, 255});
     // flag
-    SDL_SetRenderDrawColor(r, 255, 215, 0, 255);
-    SDL_RenderFillRect(r, &fr);
-    SDL_SetRenderDrawColor(r, 0, 0, 0, 255);
-    SDL_RenderRect(r, &fr);
+    q.fillRect(RenderLayer::Flag, fr, {255, 215, 0, 255});
+    q.outlineRect(RenderLayer::FlagOutline, fr, {0, 0, 0, 255});
 }
 
-static inline bool playerTouchesFlag(const Player& p, const Flag& f, float radius = 22.f) {
-    float dx = p.x() - f.x, dy = p.y() - f.y;
-    return (dx*dx + dy*dy) <= radius*radius;
+// Split-screen layout in window pixels: one view fills the window, two sit
+// side by side, three or four share a 2x2 grid (the fourth cell stays empty
+// with three players). All views of a layout have the same size.
+static std::array<SDL_FRect, WorldState::kMaxPlayers> viewRects(int players, int w, int h) {
+    std::array<SDL_FRect, WorldState::kMaxPlayers> r{};
+    const float fw = float(w), fh = float(h);
+    if (players <= 1) {
+        r[0] = { 0.f, 0.f, fw, fh };
+    } else if (players == 2) {
+        r[0] = { 0.f, 0.f, std::floor(fw * 0.5f), fh };
+        r[1] = { r[0].w, 0.f, r[0].w, fh };
+    } else {
+        const float cw = std::floor(fw * 0.5f), ch = std::floor(fh * 0.5f);
+        for (int i = 0; i < players; ++i) r[i] = { (i & 1) * cw, (i >> 1) * ch, cw, ch };
+    }
+    return r;
 }
 
-static inline bool allFlagsCollected(const std::vector<Flag>& flags) {
-    for (const auto& f : flags) if (!f.taken) return false;
-    return true;
+static bool inAnyView(std::span<const SDL_FRect> views, float x, float y, float margin) {
+    for (const SDL_FRect& v : views)
+        if (x + margin > v.x && x - margin < v.x + v.w && y + margin > v.y && y - margin < v.y + v.h) return true;
+    return false;
 }
 
-// Read the same ASCII file the Map loads, and spawn flags at 'F' tile centers.
-static void loadFlagsFromAscii(const std::string& levelPath, const Map& map, std::vector<Flag>& out) {
-    std::ifstream in(levelPath);
-    if (!in) { SDL_Log("Flag scan: cannot open %s", levelPath.c_str()); return; }
-
-    const int TILE = map.tileSize();  // <- use the Map’s tile size (prevents 16 vs 32 mismatches)  :contentReference[oaicite:3]{index=3}
-    std::string line;  int row = 0;
-    while (std::getline(in, line)) {
-        if (!line.empty() && line.back() == '\r') line.pop_back(); // windows CR
-        if (!line.empty() && (line[0]==';' || (line.size()>=2 && line[0]=='/' && line[1]=='/'))) { ++row; continue; } // skip comments like Map does  :contentReference[oaicite:4]{index=4}
-        for (int col = 0; col < (int)line.size(); ++col) {
-            if (line[col] == 'F') {
-                float wx = col * TILE + TILE * 0.5f;
-                float wy = row * TILE + TILE * 0.5f;
-                if (!map.isWallAtPixel(wx, wy)) out.push_back({wx, wy, false});  // safety  :contentReference[oaicite:5]{index=5}
-            }
-        }
-        ++row;
-    }
-}
+// keyboard bindings per seat: up, down, left, right, brake
+struct PlayerKeys { SDL_Scancode up, down, left, right, brake; };
+static constexpr PlayerKeys kPlayerKeys[WorldState::kMaxPlayers] = {
+    { SDL_SCANCODE_UP,   SDL_SCANCODE_DOWN, SDL_SCANCODE_LEFT, SDL_SCANCODE_RIGHT, SDL_SCANCODE_SPACE  },
+    { SDL_SCANCODE_W,    SDL_SCANCODE_S,    SDL_SCANCODE_A,    SDL_SCANCODE_D,     SDL_SCANCODE_LSHIFT },
+    { SDL_SCANCODE_I,    SDL_SCANCODE_K,    SDL_SCANCODE_J,    SDL_SCANCODE_L,     SDL_SCANCODE_RSHIFT },
+    { SDL_SCANCODE_KP_8, SDL_SCANCODE_KP_5, SDL_SCANCODE_KP_4, SDL_SCANCODE_KP_6,  SDL_SCANCODE_KP_0   },
+};
 
-static void loadEnemiesFromAscii(const std::string& levelPath,
-                                 const Map& map,
-                                 std::vector<EnemyCar>& out)
-{
-    std::ifstream in(levelPath);
-    if (!in) { SDL_Log("Enemy scan: cannot open %s", levelPath.c_str()); return; }
-
-    const int T = map.tileSize();
-    std::string line; int row = 0;
-    while (std::getline(in, line)) {
-        if (!line.empty() && line.back() == '\r') line.pop_back();
-        if (!line.empty() && (line[0]==';' || (line.size()>=2 && line[0]=='/' && line[1]=='/'))) { ++row; continue; }
-        for (int col = 0; col < (int)line.size(); ++col) {
-            if (line[col] == 'E') {
-                float wx = col * T + T * 0.5f;
-                float wy = row * T + T * 0.5f;
-                if (!map.isWallAtPixel(wx, wy)) out.emplace_back(wx, wy);
-            }
-        }
-        ++row;
-    }
+// Control keys a seat holds right now; rebuilt from key events, not polled.
+struct SeatKeys { bool up = false, down = false, left = false, right = false, brake = false; };
+
+// true if sc is one of the seat's keys
+static bool applyKey(SeatKeys& held, const PlayerKeys& keys, SDL_Scancode sc, bool down) {
+    if      (sc == keys.up)    held.up    = down;
+    else if (sc == keys.down)  held.down  = down;
+    else if (sc == keys.left)  held.left  = down;
+    else if (sc == keys.right) held.right = down;
+    else if (sc == keys.brake) held.brake = down;
+    else return false;
+    return true;
 }
 
-static bool loadPlayerSpawnFromAscii(const std::string& levelPath,
-                                     const Map& map,
-                                     float& outX, float& outY)
-{
-    std::ifstream in(levelPath);
-    if (!in) { SDL_Log("Spawn scan: cannot open %s", levelPath.c_str()); return false; }
-
-    const int T = map.tileSize();
-    std::string line; int row = 0;
-    while (std::getline(in, line)) {
-        if (!line.empty() && line.back() == '\r') line.pop_back();
-        if (!line.empty() && (line[0]==';' || (line.size()>=2 && line[0]=='/' && line[1]=='/'))) { ++row; continue; }
-        for (int col = 0; col < (int)line.size(); ++col) {
-            if (line[col] == 'P') {
-                outX = col * T + T * 0.5f;
-                outY = row * T + T * 0.5f;
-                if (!map.isWallAtPixel(outX, outY)) return true;
-            }
-        }
-        ++row;
+// VSync: present waits for the display. Off: uncapped. Limited: vsync off,
+// paced to the refresh rate by sleeping.
+enum class PresentMode { VSync, Off, Limited, Count };
+
+static const char* presentModeName(PresentMode m) {
+    switch (m) {
+        case PresentMode::VSync:   return "vsync";
+        case PresentMode::Off:     return "vsync off";
+        case PresentMode::Limited: return "frame-limited";
+        case PresentMode::Count:   break;
     }
-    return false;
+    return "?";
 }
 
-
 static bool init(SDLState& s) {
     if (!SDL_Init(SDL_INIT_VIDEO)) {
         std::fprintf(stderr, "SDL_Init failed: %s\n", SDL_GetError());
@@ -155,192 +144,333 @@ static void shutdown(SDLState& s) {
 
 // tries assets/idle.png, else generates a placeholder via Player::render()
 static SDL_Texture* loadCarTexture(SDL_Renderer* ren) {
+    brmem::Scope scope(MemTag::Assets);
     SDL_Texture* tex = IMG_LoadTexture(ren, "assets/idle.png");
     if (tex) SDL_SetTextureScaleMode(tex, SDL_SCALEMODE_NEAREST);
+    brmem::trackTexture(MemTag::Assets, tex);
     return tex;
 }
 
 static SDL_Texture* loadEnemyTexture(SDL_Renderer* ren) {
+    brmem::Scope scope(MemTag::Assets);
     SDL_Texture* tex = IMG_LoadTexture(ren, "assets/enemy_n.png");
     if (tex) SDL_SetTextureScaleMode(tex, SDL_SCALEMODE_NEAREST);
+    brmem::trackTexture(MemTag::Assets, tex);
+    return tex;
+}
+
+static SDL_Texture* loadDirtTexture(SDL_Renderer* ren) {
+    brmem::Scope scope(MemTag::Assets);
+    SDL_Texture* tex = IMG_LoadTexture(ren, "assets/dirt.png");
+    if (tex) SDL_SetTextureScaleMode(tex, SDL_SCALEMODE_NEAREST);
+    brmem::trackTexture(MemTag::Assets, tex);
     return tex;
 }
 
-int main(int, char**) {
+static void destroyAsset(SDL_Texture* tex) {
+    if (!tex) return;
+    brmem::untrackTexture(MemTag::Assets, tex);
+    SDL_DestroyTexture(tex);
+}
+
+int main(int argc, char** argv) {
     SDLState s;
+    brlog::init();
+
+    // local players: --players N (or -p N), 1..4; F5 recording: --capture raw|png;
+    // --check-pvs N tests each level's PVS against N random lines of sight
+    int playerCount = 1;
+    FrameCapture::Format captureFormat = FrameCapture::Format::Raw;
+    int maxGhosts = 32;
+    int pvsChecks = 0;
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (std::strcmp(argv[i], "--players") == 0 || std::strcmp(argv[i], "-p") == 0)
+            playerCount = std::clamp(std::atoi(argv[i + 1]), 1, WorldState::kMaxPlayers);
+        if (std::strcmp(argv[i], "--capture") == 0 && std::strcmp(argv[i + 1], "png") == 0)
+            captureFormat = FrameCapture::Format::Png;
+        if (std::strcmp(argv[i], "--ghosts") == 0)
+            maxGhosts = std::max(0, std::atoi(argv[i + 1]));
+        if (std::strcmp(argv[i], "--check-pvs") == 0)
+            pvsChecks = std::max(0, std::atoi(argv[i + 1]));
+    }
 
-    if (!init(s)) { shutdown(s); return 1; }
+    if (!init(s)) { shutdown(s); brlog::shutdown(); return 1; }
 
     // load car sprite (PNG w/ transparent background, oriented “up”)
     SDL_Texture* carTex = loadCarTexture(s.renderer);
     SDL_Texture* enemyTex = loadEnemyTexture(s.renderer);
-
-    static constexpr float kPlayerRadius = 12.0f;
-    static constexpr float kEnemyRadius  = 15.0f;
-
-    auto playerHitEnemy = [&](const Player& p, const EnemyCar& e) -> bool {
-        const float dx = p.x() - e.x();
-        const float dy = p.y() - e.y();
-        const float r  = kPlayerRadius + kEnemyRadius;
-        return (dx*dx + dy*dy) <= (r * r);
+    SDL_Texture* dirtTex = loadDirtTexture(s.renderer);
+
+    // one camera per player, each sized to its split-screen view
+    std::array<Camera, WorldState::kMaxPlayers> cameras;
+    std::array<SDL_FRect, WorldState::kMaxPlayers> viewports{};
+    auto layoutViews = [&](int w, int h) {
+        viewports = viewRects(playerCount, w, h);
+        for (int i = 0; i < playerCount; ++i) cameras[i].setViewport(viewports[i].w, viewports[i].h);
     };
 
-    // create  Player in the middle of the current render size
-    int rw = s.winW, rh = s.winH;
-    if (s.logicalW > 0 && s.logicalH > 0) { rw = s.logicalW; rh = s.logicalH; }
-    Player car(float(rw) * 0.5f, float(rh) * 0.5f, -90.f);
-
-    Camera camera;
-    {
-        int outW=0, outH=0;
-        SDL_GetRenderOutputSize(s.renderer, &outW, &outH);
-        camera.setViewport((float)outW, (float)outH);
+    // levels are played in file-name order; each one lives in the same
+    // preallocated arena, dropped wholesale on the switch to the next
+    const std::vector<std::string> levelPaths = Level::discover("levels");
+    Level level;
+    MapLod mapLod;     // zoomed-out map textures, rebuilt per level
+    TimeTrial trial;   // earlier runs of the level as ghosts; solo runs are recorded
+    trial.setMaxGhosts(maxGhosts);
+    size_t levelIdx = 0;
+    auto loadLevel = [&](size_t first) {
+        for (levelIdx = first; levelIdx < levelPaths.size(); ++levelIdx) {
+            std::string err;
+            if (level.load(levelPaths[levelIdx], /*tile=*/32, &err)) {
+                level.map().setTileTexture(TileSprite::Dirt, dirtTex);
+                mapLod.build(s.renderer, level.map());
+                if (pvsChecks > 0) {
+                    const int wrong = level.pvs().verify(level.map(), pvsChecks, 1);
+                    if (wrong) BR_LOG_ERROR("PVS hides {} of {} clear lines of sight", wrong, pvsChecks);
+                    else       BR_LOG_INFO("PVS check: {} lines of sight, none hidden", pvsChecks);
+                }
+                trial.beginLevel(levelPaths[levelIdx], playerCount == 1);
+                brmem::report("level load");
+                return true;
+            }
+            BR_LOG_ERROR("Map load failed: {}", err);
+        }
+        return false;
+    };
+    auto levelStart = [&](int lives) {
+        WorldState w = level.start();
+        w.playerCount = playerCount;
+        w.lives = lives;
+        w.rng.seed(uint32_t(SDL_GetPerformanceCounter()));
+        return w;
+    };
+    if (!loadLevel(0)) {
+        BR_LOG_ERROR("No playable level in levels/");
+        shutdown(s);
+        brlog::shutdown();
+        return 1;
     }
+    layoutViews(s.winW, s.winH); // important for correct camera-space drawing
 
-    // Create and load a basic map
-    Map map;
-    std::string mapErr;
-    std::string levelPath = "levels/level1.txt";   // same path used by Map::loadFromFile
-    std::string err;
-    if (!map.loadFromFile(levelPath, /*tile=*/32, &err)) { SDL_Log("Map load failed: %s", err.c_str()); }
-    camera.setViewport(s.winW, s.winH); // important for correct camera-space drawing  :contentReference[oaicite:6]{index=6}
+    // from here on the main thread is the render loop; anything it allocates
+    // without a narrower scope is charged to rendering
+    brmem::Scope renderScope(MemTag::Render);
 
-    std::vector<Flag> flags;
-    loadFlagsFromAscii(levelPath, map, flags);
-    SDL_Log("Loaded %zu flags", flags.size());
+    // per-frame draw commands, sorted and batched on flush; the world goes
+    // through the scaled offscreen pass, the HUD stays at native resolution
+    RenderQueue queue;
+    RenderQueue hudQueue;
 
-    std::vector<EnemyCar> enemies;
-    std::vector<SDL_FPoint> enemySpawns;
-
-    loadEnemiesFromAscii(levelPath, map, enemies);
-    enemySpawns.reserve(enemies.size());
-    for (const auto& e : enemies) enemySpawns.push_back({e.x(), e.y()});
-    SDL_Log("Loaded %zu enemies", enemies.size());
-
-    // timing   high res
-    Uint64 now = SDL_GetPerformanceCounter();
-    const auto freq = (double)SDL_GetPerformanceFrequency();
+    // world resolution follows frame time to hold the display's refresh rate
+    DynamicResolution dynres;
+    float refreshHz = 60.f;
+    {
+        const SDL_DisplayMode* mode = SDL_GetCurrentDisplayMode(SDL_GetDisplayForWindow(s.window));
+        if (mode && mode->refresh_rate > 0.f) refreshHz = mode->refresh_rate;
+        dynres.init(s.renderer, s.winW, s.winH, refreshHz);
+    }
+    Uint64 lastPresent = SDL_GetPerformanceCounter();
+
+    // input-to-present latency per present mode; F6 reports, F7 cycles modes
+    PresentMode presentMode = PresentMode::VSync;
+    std::array<InputLatency, size_t(PresentMode::Count)> latency;
+    Uint64 nextFrameNs = SDL_GetTicksNS();
+    auto setPresentMode = [&](PresentMode m) {
+        if (!SDL_SetRenderVSync(s.renderer, m == PresentMode::VSync ? 1 : 0) && m == PresentMode::VSync)
+            m = PresentMode::Limited;   // no vsync here: pace by sleeping instead
+        presentMode = m;
+        nextFrameNs = SDL_GetTicksNS();
+        BR_LOG_INFO("Present mode: {}", presentModeName(m));
+    };
 
-    // steering keys    rate-limited
-    bool steerLeft = false, steerRight = false;
+    // key events become timestamped input events for the sim. Each carries
+    // the seat's whole key state, so a seat whose event could not be queued
+    // (paused, or the queue full) just sends its current state later,
+    // stamped with the newest event time seen so the queue stays in order.
+    std::array<SeatKeys, WorldState::kMaxPlayers> seats{};
+    std::array<bool, WorldState::kMaxPlayers> unsent{};
+    uint64_t inputSeq = 0;
+    Uint64 lastEventNs = 0;
+
+    bool fogOfWar = true;
+    bool overview = false;
+    bool showGhosts = true;
+    float playZoom = 1.f;   // zoom to return to when leaving the overview
     bool running = true;
 
-    float spawnX = car.x(), spawnY = car.y();
-    if (loadPlayerSpawnFromAscii(levelPath, map, spawnX, spawnY)) {
-        car.setPosition(spawnX, spawnY);
-        car.setHeading(-90.f);
-    }
+    // all views share one zoom, so the world pass can use a single render scale
+    auto setZoom = [&](float z) {
+        for (int i = 0; i < playerCount; ++i) cameras[i].setZoom(z);
+    };
 
-    int lives = 3;
+    // physics, AI and pickups tick on their own thread; this thread only
+    // pumps events and draws the newest published snapshot. The simulation
+    // (world state, rollback ring, snapshot buffers) is the entity budget;
+    // it lives on the heap so the accounting sees it, not on the stack.
+    // It refers into the loaded level, so each level gets a fresh one.
+    std::unique_ptr<Simulation> sim;
+    auto startLevelSim = [&](int lives) {
+        {
+            brmem::Scope scope(MemTag::Entities);
+            sim = std::make_unique<Simulation>(level.map(), level.nav(), level.pvs(), levelStart(lives), inputSeq);
+        }
+        if (playerCount == 1) sim->setGhostFeed(&trial.feed());
+    };
+    startLevelSim(3);
+    sim->start();
+
+    // gameplay recording, toggled with F5
+    FrameCapture recorder;
+
+    // once queues and caches have grown to size the frame loop must not allocate
+    brmem::AllocWatch frameWatch("Frame loop");
+    int warmupFrames = 60;
+
+    // Pause (P), lost focus and a hidden window all idle: the sim thread is
+    // stopped and this thread sleeps in SDL_WaitEvent, drawing a frame only
+    // when the window needs one.
+    bool userPaused = false, unfocused = false, hidden = false;
+    bool idle = false;
+    bool redraw = false;   // idle: repaint once (just paused, exposed, resized)
+
+    auto sendSeat = [&](int i, Uint64 timeNs) {
+        const SeatKeys& k = seats[i];
+        InputEvent in;
+        in.timeNs   = timeNs;
+        in.seq      = inputSeq + 1;
+        in.player   = i;
+        in.throttle = float(k.up) - float(k.down);
+        in.brake    = k.brake ? 1.f : 0.f;
+        in.steer    = float(k.right) - float(k.left);
+        unsent[i] = !sim->pushInput(in);
+        if (unsent[i]) return;
+        ++inputSeq;
+        latency[size_t(presentMode)].sent(in.seq, in.timeNs);
+    };
 
     while (running) {
-        // events
+        // events; idle blocks here until something happens
         SDL_Event e;
-        while (SDL_PollEvent(&e)) {
+        bool waited = idle && !redraw && SDL_WaitEvent(&e);
+        while (waited || SDL_PollEvent(&e)) {
+            waited = false;
+            lastEventNs = std::max(lastEventNs, e.common.timestamp);
+            if ((e.type == SDL_EVENT_KEY_DOWN || e.type == SDL_EVENT_KEY_UP) && !e.key.repeat) {
+                for (int i = 0; i < playerCount; ++i) {
+                    if (!applyKey(seats[i], kPlayerKeys[i], e.key.scancode, e.type == SDL_EVENT_KEY_DOWN)) continue;
+                    if (idle) unsent[i] = true;   // the sim is stopped; sent on resume
+                    else      sendSeat(i, e.key.timestamp);
+                }
+            }
+
             if (e.type == SDL_EVENT_QUIT) {
                 running = false;
             } else if (e.type == SDL_EVENT_WINDOW_RESIZED) {
                 s.winW = e.window.data1;
                 s.winH = e.window.data2;
-                camera.setViewport((float)s.winW, (float)s.winH);
+                layoutViews(s.winW, s.winH);
+                dynres.resize(s.winW, s.winH);
+                redraw = true;
+            } else if (e.type == SDL_EVENT_WINDOW_PIXEL_SIZE_CHANGED) {
+                dynres.resize(s.winW, s.winH);   // e.g. moved to a display with another scale
+                redraw = true;
+            } else if (e.type == SDL_EVENT_WINDOW_FOCUS_LOST) {
+                unfocused = true;
+            } else if (e.type == SDL_EVENT_WINDOW_FOCUS_GAINED) {
+                unfocused = false;
+            } else if (e.type == SDL_EVENT_WINDOW_MINIMIZED || e.type == SDL_EVENT_WINDOW_HIDDEN ||
+                       e.type == SDL_EVENT_WINDOW_OCCLUDED) {
+                hidden = true;
+            } else if (e.type == SDL_EVENT_WINDOW_RESTORED || e.type == SDL_EVENT_WINDOW_SHOWN ||
+                       e.type == SDL_EVENT_WINDOW_EXPOSED) {
+                hidden = false;
+                redraw = true;
             } else if (e.type == SDL_EVENT_KEY_DOWN && !e.key.repeat) {
                 if (e.key.key == SDLK_ESCAPE) running = false;
-                if (e.key.key == SDLK_LEFT)  steerLeft  = true;
-                if (e.key.key == SDLK_RIGHT) steerRight = true;
-                if (e.key.key == SDLK_R) { // reset to center
-                    int rw2 = s.winW, rh2 = s.winH;
-                    if (s.logicalW > 0 && s.logicalH > 0) { rw2 = s.logicalW; rh2 = s.logicalH; }
-                    car = Player(float(rw2) * 0.5f, float(rh2) * 0.5f, -90.f);
+                if (e.key.key == SDLK_P) userPaused = !userPaused;
+                if (e.key.key == SDLK_R) sim->requestRetry();           // restart level from its start snapshot
+                if (e.key.key == SDLK_BACKSPACE) sim->requestRewind(2.f); // roll back ~2 s
+                if (e.key.key == SDLK_F3) fogOfWar = !fogOfWar;          // fog of war on/off
+                if (e.key.key == SDLK_F4) brmem::report("on demand");    // memory footprint
+                if (e.key.key == SDLK_F6) latency[size_t(presentMode)].report(presentModeName(presentMode));
+                if (e.key.key == SDLK_F7) {                              // next present mode
+                    latency[size_t(presentMode)].report(presentModeName(presentMode));
+                    setPresentMode(PresentMode((int(presentMode) + 1) % int(PresentMode::Count)));
                 }
-            } else if (e.type == SDL_EVENT_KEY_UP && !e.key.repeat) {
-                if (e.key.key == SDLK_LEFT)  steerLeft  = false;
-                if (e.key.key == SDLK_RIGHT) steerRight = false;
-            }
-        }
-
-        // input    continuous
-        const bool* ks = SDL_GetKeyboardState(NULL);
-        float throttle = 0.f;
-        if (ks[SDL_SCANCODE_UP])   throttle += 1.f;
-        if (ks[SDL_SCANCODE_DOWN]) throttle -= 1.f;
-
-        float brake = ks[SDL_SCANCODE_SPACE] ? 1.f : 0.f;
-
-        float steerIn = 0.f;
-        if (steerLeft)  steerIn -= 1.f;
-        if (steerRight) steerIn += 1.f;
-
-        // timing
-        Uint64 newNow = SDL_GetPerformanceCounter();
-        auto dt = float((double)(newNow - now) / freq);
-        now = newNow;
-        if (dt > 1.f/30.f) dt = 1.f/30.f; // clamp spikes
-
-        // update
-        car.setInputs(throttle, brake, steerIn);
-        car.update(dt, map, TILE);
-
-        // temp simple bounds in current render space
-        int curW = s.winW, curH = s.winH;
-        if (s.logicalW > 0 && s.logicalH > 0) { curW = s.logicalW; curH = s.logicalH; }
-
-        // Follow player (world size from map)
-        const float worldW = (float)map.worldPixelWidth();
-        const float worldH = (float)map.worldPixelHeight();
-        camera.follow(car.x(), car.y(), worldW, worldH);
-
-        // render
-        SDL_SetRenderDrawColor(s.renderer, 24, 28, 32, 255);
-        SDL_RenderClear(s.renderer);
-
-        for (auto& e : enemies)
-            e.update(dt, map, car.x(), car.y());
-
-        bool collided = false;
-        for (const auto& e : enemies) {
-            if (playerHitEnemy(car, e)) {
-                collided = true;
-                break;
+                if (e.key.key == SDLK_F5) {                              // start / stop recording
+                    if (recorder.active()) recorder.stop();
+                    else recorder.start(s.renderer, "captures", captureFormat);
+                    frameWatch.rearm();                                  // frame buffers are allocated here
+                }
+                if (e.key.key == SDLK_G) showGhosts = !showGhosts;       // ghost cars on/off
+                if (e.key.key == SDLK_TAB) {                             // whole-map view
+                    overview = !overview;
+                    if (overview) playZoom = cameras[0].zoom;
+                    else          setZoom(playZoom);
+                }
+                if (e.key.key == SDLK_EQUALS) setZoom(cameras[0].zoom * 1.25f);
+                if (e.key.key == SDLK_MINUS)  setZoom(cameras[0].zoom / 1.25f);
+                if (e.key.key == SDLK_F2) {                              // dynamic resolution on/off
+                    dynres.setEnabled(!dynres.isRequested());
+                    if (dynres.isRequested() && !dynres.enabled())
+                        BR_LOG_WARN("Dynamic resolution on, but there is no render target: drawing at native size");
+                    else
+                        BR_LOG_INFO("Dynamic resolution {}", dynres.enabled() ? "on" : "off");
+                }
+            } else if (e.type == SDL_EVENT_MOUSE_WHEEL) {
+                setZoom(cameras[0].zoom * std::pow(1.1f, e.wheel.y));
             }
         }
 
-        if (collided) {
-            lives--;
-
-            if (lives > 0) {
-                // Respawn player at level spawn, fully reset dynamics
-                car = Player(spawnX, spawnY, -90.f);
-
-                // Respawn each enemy at its original spawn point
-                enemies.clear();
-                enemies.reserve(enemySpawns.size());
-                for (const auto& p : enemySpawns) {
-                    enemies.emplace_back(p.x, p.y);
-                }
-
-                // Optional: brief grace period (invuln) – skip updates a few frames, etc.
-                // (You can add a timer if you like.)
+        const bool nowIdle = userPaused || unfocused || hidden;
+        if (nowIdle != idle) {
+            idle = nowIdle;
+            if (idle) {
+                sim->stop();
+                latency[size_t(presentMode)].skipPending();
+                redraw = true;
+                BR_LOG_INFO("Paused ({})", userPaused ? "P" : hidden ? "window hidden" : "focus lost");
             } else {
-                SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_INFORMATION,
-                                         "Game Over",
-                                         "You ran out of lives!",
-                                         s.window);
-                running = false;
+                // ticks rebase on the current time in start(); so do frame times
+                sim->start();
+                lastPresent = SDL_GetPerformanceCounter();
+                nextFrameNs = SDL_GetTicksNS();
+                frameWatch.rearm();
+                for (int i = 0; i < playerCount; ++i) unsent[i] = true;   // keys as held now
+                BR_LOG_INFO("Resumed");
             }
         }
+        // state the queue could not take before: the latest replaces it
+        if (!idle)
+            for (int i = 0; i < playerCount; ++i)
+                if (unsent[i]) sendSeat(i, lastEventNs);
+        if (!running) break;
+        if (idle && (!redraw || hidden)) { redraw = false; continue; }
+
+        // newest tick; never blocks on the sim thread. Input pushed this frame
+        // shows once the tick covering its timestamp has run.
+        const RenderSnapshot& snap = sim->latest();
+
+        if (snap.status == SimStatus::Lost) {
+            SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_INFORMATION,
+                                     "Game Over",
+                                     "You ran out of lives!",
+                                     s.window);
+            running = false;
+            continue;
+        }
 
-
-
-        // Collect
-        for (auto& f : flags) {
-            if (!f.taken && playerTouchesFlag(car, f)) {
-                f.taken = true;
-                // game.collectFlag(); // if you’re using your Game counter
+        // Win check: on to the next level, or done after the last one
+        if (snap.status == SimStatus::Won) {
+            const int lives = snap.world.lives;   // snap is gone with the sim
+            sim.reset();   // before the level it points into is unloaded
+            if (loadLevel(levelIdx + 1)) {
+                startLevelSim(lives);
+                for (int i = 0; i < playerCount; ++i) unsent[i] = true;   // keys as held now
+                if (!idle) sim->start();
+                warmupFrames = 60;
+                continue;
             }
-        }
 
-        // Win check
-        if (allFlagsCollected(flags)) {
             // Option A: quick native popup (zero extra libs)
             SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_INFORMATION,
                                      "You Win!", "All flags collected!", s.window);
@@ -350,35 +480,154 @@ int main(int, char**) {
             continue; // break out cleanly after showing the message
         }
 
-        map.render(s.renderer, camera);            // only visible tiles, offset by camera
-        car.render(s.renderer, carTex, camera);    // draw player relative to camera
+        const Map& map = level.map();
 
-        for (auto& e : enemies)
-            e.render(s.renderer, enemyTex, camera);
-        for (const auto& f : flags) renderFlag(s.renderer, camera, f);
-        // simple velocity bar
-        float spd = std::abs(car.speed());
+        // Each camera follows its own player (world size from map); the overview frames the whole map
+        const float worldW = (float)map.worldPixelWidth();
+        const float worldH = (float)map.worldPixelHeight();
+        const auto players = snap.world.activePlayers();
+        if (overview) setZoom(cameras[0].fitZoom(worldW, worldH));
+        std::array<SDL_FRect, WorldState::kMaxPlayers> views{};   // world rect of each view
+        std::array<SDL_FPoint, WorldState::kMaxPlayers> eyes{};
+        for (int i = 0; i < playerCount; ++i) {
+            if (overview) cameras[i].follow(worldW * 0.5f, worldH * 0.5f, worldW, worldH);
+            else          cameras[i].follow(players[i].x(), players[i].y(), worldW, worldH);
+            views[i] = cameras[i].view;
+            eyes[i] = { players[i].x(), players[i].y() };
+        }
+        const std::span<const SDL_FRect> viewSpan(views.data(), size_t(playerCount));
+
+        // Shared culling pass: the world is recorded and sorted once against
+        // the bounding box of all views, skipping what falls between them,
+        // then submitted once per view with that view's offset and clip.
+        Camera gather = cameras[0];
+        for (const SDL_FRect& v : viewSpan) {
+            const float x1 = std::max(gather.view.x + gather.view.w, v.x + v.w);
+            const float y1 = std::max(gather.view.y + gather.view.h, v.y + v.h);
+            gather.view.x = std::min(gather.view.x, v.x);
+            gather.view.y = std::min(gather.view.y, v.y);
+            gather.view.w = x1 - gather.view.x;
+            gather.view.h = y1 - gather.view.y;
+        }
 
-        // Draw Lives
+        // render; zoom is applied as render scale, so everything below draws in world units
+        const float zoom = cameras[0].zoom;
+        const float pixelsPerUnit = zoom * dynres.scale();
+        dynres.beginWorld({24, 28, 32, 255}, zoom);
+
+        // fog of war: recast only when a player changes tile; unexplored
+        // tiles, unseen enemies and undiscovered flags are never submitted
+        const Visibility* fog = nullptr;
+        if (fogOfWar) {
+            level.visibility().update(map, std::span<const SDL_FPoint>(eyes.data(), size_t(playerCount)));
+            fog = &level.visibility();
+        }
+
+        // zoomed far out the map is one quad from the LOD chain instead of a quad per tile
+        const std::span<const SDL_FRect> tileViews = playerCount > 1 ? viewSpan : std::span<const SDL_FRect>{};
+        if (mapLod.active(map, pixelsPerUnit)) mapLod.render(queue, gather, map, pixelsPerUnit, fog);
+        else                                   map.render(queue, gather, fog, tileViews); // only visible tiles, offset by camera
+        if (showGhosts) trial.render(queue, carTex, gather, snap.world.tick, viewSpan);
+        for (const auto& p : players)
+            if (inAnyView(viewSpan, p.x(), p.y(), 64.f)) p.render(queue, carTex, gather);
+
+        for (const auto& e : snap.world.activeEnemies())
+            if ((!fog || fog->visibleAtPixel(e.x(), e.y())) && inAnyView(viewSpan, e.x(), e.y(), 64.f))
+                e.render(queue, enemyTex, gather);
+        for (const auto& f : snap.world.activeFlags())
+            if ((!fog || fog->exploredAtPixel(f.x, f.y)) && inAnyView(viewSpan, f.x, f.y, 32.f))
+                renderFlag(queue, gather, f);
+
+        if (playerCount == 1) {
+            queue.flush(s.renderer);
+        } else {
+            queue.sort();
+            for (int i = 0; i < playerCount; ++i) {
+                // viewports are in window pixels; the world pass is scaled by zoom
+                const SDL_FRect& vp = viewports[i];
+                const SDL_Rect clip{ int(std::floor(vp.x / zoom)), int(std::floor(vp.y / zoom)),
+                                     int(std::ceil(vp.w / zoom)), int(std::ceil(vp.h / zoom)) };
+                const SDL_FRect cull{ views[i].x - gather.view.x, views[i].y - gather.view.y, views[i].w, views[i].h };
+                SDL_SetRenderClipRect(s.renderer, &clip);
+                queue.submit(s.renderer, vp.x / zoom - cull.x, vp.y / zoom - cull.y, &cull);
+            }
+            SDL_SetRenderClipRect(s.renderer, nullptr);
+            queue.clear();
+        }
+        dynres.endWorld();
+
+        // Draw Lives (shared by all players)
+        int curH = s.winH;
+        if (s.logicalW > 0 && s.logicalH > 0) { curH = s.logicalH; }
+        const float livesY = playerCount > 2 ? viewports[0].h - 48.f : float(curH) - 48.f;
         for (int i = 0; i < 3; ++i) {
-            SDL_FRect life { 20.f + i * 18.f, float(curH) - 48.f, 12.f, 12.f };
-            if (i < lives) SDL_SetRenderDrawColor(s.renderer, 255, 60, 60, 255);
-            else           SDL_SetRenderDrawColor(s.renderer, 80, 80, 80, 255);
-            SDL_RenderFillRect(s.renderer, &life);
+            SDL_FRect life { 20.f + i * 18.f, livesY, 12.f, 12.f };
+            hudQueue.fillRect(RenderLayer::Hud, life, i < snap.world.lives ? SDL_Color{255, 60, 60, 255}
+                                                                           : SDL_Color{80, 80, 80, 255});
         }
 
-        curW = s.winW, curH = s.winH;
-        if (s.logicalW > 0 && s.logicalH > 0) { curW = s.logicalW; curH = s.logicalH; }
-        SDL_FRect hud { 20.f, float(curH) - 28.f, std::min(spd / 1200.f, 1.f) * 300.f, 8.f };
-        SDL_SetRenderDrawColor(s.renderer, 0, 200, 120, 255);
-        SDL_RenderFillRect(s.renderer, &hud);
+        // simple velocity bar per view
+        for (int i = 0; i < playerCount; ++i) {
+            const SDL_FRect& vp = viewports[i];
+            const float spd = std::abs(players[i].speed());
+            SDL_FRect hud { vp.x + 20.f, vp.y + std::min(vp.h, float(curH)) - 28.f,
+                            std::min(spd / 1200.f, 1.f) * std::min(300.f, vp.w - 40.f), 8.f };
+            hudQueue.fillRect(RenderLayer::Hud, hud, {0, 200, 120, 255});
+        }
 
-        SDL_RenderPresent(s.renderer);
+        // dividers between views
+        if (playerCount > 1) {
+            const SDL_Color line{8, 8, 8, 255};
+            hudQueue.fillRect(RenderLayer::Hud, { viewports[1].x - 2.f, 0.f, 4.f, float(s.winH) }, line);
+            if (playerCount > 2)
+                hudQueue.fillRect(RenderLayer::Hud, { 0.f, viewports[2].y - 2.f, float(s.winW), 4.f }, line);
+        }
+        // paused: a pause sign over the frozen frame
+        if (idle) {
+            const float cx = float(s.winW) * 0.5f, cy = float(s.winH) * 0.5f;
+            hudQueue.fillRect(RenderLayer::Hud, { cx - 22.f, cy - 30.f, 14.f, 60.f }, {240, 240, 240, 255});
+            hudQueue.fillRect(RenderLayer::Hud, { cx + 8.f,  cy - 30.f, 14.f, 60.f }, {240, 240, 240, 255});
+        }
+        hudQueue.flush(s.renderer);
 
-        SDL_Delay(1);
+        recorder.capture(s.renderer);   // finished frame, before present hands it off
+        SDL_RenderPresent(s.renderer);
+        if (idle) {
+            redraw = false;
+            continue;
+        }
+        latency[size_t(presentMode)].presented(snap.inputSeq, SDL_GetTicksNS());
+
+        const Uint64 now = SDL_GetPerformanceCounter();
+        dynres.frameTime(double(now - lastPresent) / double(SDL_GetPerformanceFrequency()));
+        lastPresent = now;
+
+        if (warmupFrames > 0) { --warmupFrames; frameWatch.rearm(); }
+        else                  frameWatch.check();
+
+        // vsync paces inside present; the limiter sleeps to the next refresh
+        // deadline, resyncing after a slow frame rather than rushing to catch up
+        if (presentMode == PresentMode::Limited) {
+            nextFrameNs += Uint64(1e9 / double(refreshHz));
+            const Uint64 t = SDL_GetTicksNS();
+            if (nextFrameNs > t) SDL_DelayPrecise(nextFrameNs - t);
+            else                 nextFrameNs = t;
+        }
     }
 
-    if (carTex) SDL_DestroyTexture(carTex);
+    if (sim) sim->stop();
+    for (int m = 0; m < int(PresentMode::Count); ++m)
+        if (latency[m].samples() > 0) latency[m].report(presentModeName(PresentMode(m)));
+    recorder.stop();
+    trial.stop();   // after the sim: an unfinished run is not kept
+    brmem::report("exit");
+
+    destroyAsset(carTex);
+    destroyAsset(enemyTex);
+    destroyAsset(dirtTex);
+    mapLod.release();
+    dynres.shutdown();
     shutdown(s);
+    brlog::shutdown();
     return 0;
 }